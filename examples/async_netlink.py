@@ -0,0 +1,162 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+from typing import Callable, Optional
+import asyncio
+import struct
+import os
+
+NLMSG_ERROR = 2
+NLMSG_DONE = 3
+NLM_F_MULTI = 0x2
+NLM_F_ACK = 0x4
+
+
+class AsyncNetLink:
+    """
+        asyncio layer over a NetLink.
+
+        The socket is watched with loop.add_reader, every time it is readable it is drained with recv_many
+        and the messages are matched to the pending requests by their sequence number,
+        so many requests can be in flight on one socket.
+        Replies lost to a receive buffer overrun make their requests time out (see NetLink.set_overrun_callback).
+        Messages that don't belong to any request (multicast events for example) are passed to on_message.
+    """
+
+    MAX_MESSAGES_PER_WAKEUP = 256
+
+    def __init__(self, netlink: NetLink, on_message: Optional[Callable[[Message], None]] = None):
+        self.netlink = netlink
+        self.on_message = on_message
+        self.loop = asyncio.get_running_loop()
+        self.__pending = {}
+
+        self.loop.add_reader(self.netlink.fileno(), self.__on_readable)
+
+    async def request(self, message: Message, timeout: Optional[float] = None) -> list[Message]:
+        """
+            Sends a request and waits for its response.
+
+            The request is complete when:
+                * an ack arrives (if the message requested one), or
+                * NLMSG_DONE arrives (multipart responses), or
+                * the first reply arrives (neither of the above).
+
+            @param message the request.
+            @param timeout seconds to wait, None to wait forever.
+            @return the replies (without the ack / NLMSG_DONE).
+            @raise OSError if the kernel answered with an error.
+        """
+
+        seq = self.netlink.send(message)
+        flags = message.parse_header()[2]
+
+        future = self.loop.create_future()
+        self.__pending[seq] = (future, [], bool(flags & NLM_F_ACK))
+
+        try:
+            return await asyncio.wait_for(future, timeout)
+        finally:
+            self.__pending.pop(seq, None)
+
+    def close(self):
+        """
+            Stops watching the socket and fails the pending requests.
+            The NetLink itself is not closed.
+        """
+
+        self.loop.remove_reader(self.netlink.fileno())
+
+        for future, _, _ in self.__pending.values():
+            if not future.done():
+                future.set_exception(ConnectionAbortedError("The netlink was closed"))
+
+        self.__pending.clear()
+
+    def __on_readable(self):
+        """
+            Drains the socket and dispatches the messages.
+        """
+
+        try:
+            messages, _, _ = self.netlink.recv_many(AsyncNetLink.MAX_MESSAGES_PER_WAKEUP, 0)
+        except OSError:
+            # the socket failed, the pending requests will time out.
+            return
+
+        for message in messages:
+            self.__dispatch(message)
+
+    def __dispatch(self, message: Message):
+        """
+            Matches a message to its request.
+
+            @param message the received message.
+        """
+
+        _, msg_type, flags, seq, _ = message.parse_header()
+        pending = self.__pending.get(seq)
+
+        if pending is None:
+            if self.on_message is not None:
+                self.on_message(message)
+            return
+
+        future, replies, ack = pending
+
+        if future.done():
+            return
+
+        if msg_type == NLMSG_ERROR:
+            error, = struct.unpack_from("i", message.get_bytes(), NetLink.HEADER_LEN)
+
+            if error:
+                future.set_exception(OSError(-error, os.strerror(-error)))
+            else:
+                future.set_result(replies)
+        elif msg_type == NLMSG_DONE:
+            if not ack:
+                future.set_result(replies)
+        else:
+            replies.append(message)
+
+            if not ack and not flags & NLM_F_MULTI:
+                future.set_result(replies)
+
+
+if __name__ == "__main__":
+    NETLINK_ROUTE = 0
+    RTM_GETLINK = 18
+    NLM_F_REQUEST = 0x1
+
+    async def main():
+        nl = AsyncNetLink(NetLink(0, NETLINK_ROUTE, 0, []))
+
+        def get_link(index: int) -> Message:
+            message = Message(RTM_GETLINK, 0, NLM_F_REQUEST)
+            message.append(struct.pack("Bxxxiii", 0, index, 0, 0), 4) # struct ifinfomsg
+            return message
+
+        results = await asyncio.gather(*(nl.request(get_link(1), 1) for _ in range(16)),
+                                       nl.request(get_link(99999), 1), return_exceptions=True)
+
+        print("[+] %d replies, last request: %r" % (sum(isinstance(r, list) for r in results), results[-1]))
+        nl.close()
+
+    asyncio.run(main())
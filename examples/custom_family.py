@@ -16,9 +16,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 """
 
-from netlink import AttributePolicy, CB_Kind, CB_Type, Attribute, Message
-
-from generic_netlink import GenericNetLink, GenericMessage
+from netlink import AttributePolicy, CB_Kind, CB_Type, Attribute, Message, GenericNetLink, GenericMessage
 
 
 class CustomFamilyAttributes:
@@ -66,7 +64,7 @@ class CustomFamily(GenericNetLink):
             Defines all of the callbacks the family uses.
         """
 
-        self.modify_cb(CB_Type.CB_VALID, CB_Kind.CB_CUSTOM, self.recv_messages)
+        self.modify_cb(CB_Kind.CB_CUSTOM, CB_Type.CB_VALID, self.recv_messages)
 
     def recv_messages(self, message: Message):
         """
@@ -79,11 +77,12 @@ class CustomFamily(GenericNetLink):
 
         if cmd == CustomFamilyCommands.RECV:
             print("[+] Received RECV command")
-            
-            for attribute in attributes:
-                if attribute.type == CustomFamilyAttributes.MSG_A:
-                    print("   * Received %d bytes from kernel" % attribute.len)
-                    print("   * Data: ", attribute.data)
+
+            attribute = attributes.get(CustomFamilyAttributes.MSG_A)
+
+            if attribute is not None:
+                print("   * Received %d bytes from kernel" % attribute.len)
+                print("   * Data: ", attribute.data)
                   
                     
        
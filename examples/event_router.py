@@ -0,0 +1,61 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+import socket
+import struct
+
+NETLINK_ROUTE = 0
+RTNLGRP_LINK = 1
+RTNLGRP_IPV4_IFADDR = 5
+RTNLGRP_IPV6_IFADDR = 9
+RTM_NEWLINK = 16
+RTM_DELLINK = 17
+RTM_NEWADDR = 20
+RTM_DELADDR = 21
+
+
+def on_address(message: Message):
+    _, msg_type, _, _, _ = message.parse_header()
+    family, prefixlen, _, _, index = struct.unpack_from("BBBBi", message.get_bytes(), NetLink.HEADER_LEN) # struct ifaddrmsg
+
+    print("[+] address %s on link %d (%s/%d)" % ("added" if msg_type == RTM_NEWADDR else "removed", index,
+                                                 "inet" if family == socket.AF_INET else "inet6", prefixlen))
+
+
+def on_link(message: Message):
+    index, = struct.unpack_from("i", message.get_bytes(), NetLink.HEADER_LEN + 4) # ifinfomsg.ifi_index
+    print("[+] link %d changed" % index)
+
+
+if __name__ == "__main__":
+    netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+
+    for group in (RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR, RTNLGRP_IPV6_IFADDR):
+        netlink.add_membership(group)
+
+    # events that match no rule are dropped in the kernel, before they are even queued on the socket.
+    netlink.attach_filter([{"type": msg_type} for msg_type in (RTM_NEWLINK, RTM_DELLINK, RTM_NEWADDR, RTM_DELADDR)])
+
+    # the routes are looked up in C, events without a handler never reach python.
+    netlink.route(on_address, type=RTM_NEWADDR)
+    netlink.route(on_address, type=RTM_DELADDR)
+    netlink.route(on_link, group=RTNLGRP_LINK)
+
+    while True:
+        received, handled = netlink.dispatch(-1)
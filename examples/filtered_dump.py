@@ -0,0 +1,38 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+import socket
+import sys
+
+NETLINK_ROUTE = 0
+RT_TABLE_MAIN = 254
+
+
+if __name__ == "__main__":
+    ifindex = socket.if_nametoindex(sys.argv[1]) if len(sys.argv) > 1 else 1
+
+    netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+    # the kernel filters the dumps itself, only the matching objects are sent.
+    netlink.set_strict_check(True)
+
+    routes = list(netlink.dump(Message.route_dump(socket.AF_INET, table=RT_TABLE_MAIN, oif=ifindex)))
+    addresses = list(netlink.dump(Message.addr_dump(ifindex=ifindex)))
+    neighbours = list(netlink.dump(Message.neigh_dump(ifindex=ifindex)))
+
+    print("[+] link %d: %d main table routes, %d addresses, %d neighbours" % (ifindex, len(routes), len(addresses), len(neighbours)))
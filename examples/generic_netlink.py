@@ -16,99 +16,42 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 """
 
-from netlink import NetLink, Message, CB_Kind, CB_Type, AttributePolicy, Attribute
-import struct
+from netlink import GenericNetLink, AttributePolicy, Attribute
 
+# GenericNetLink and GenericMessage are native types: the generic netlink header is put with genlmsg_put,
+# cmd and version are read straight from the received buffer and parse_message indexes the attributes
+# with genlmsg_parse, without copying the payload.
 
-class GenericMessage(Message):
-    """
-        Defines a generic message.
-
-        This message is sendable and will add automatically the generic header.
-    """
-
-    def __init__(self, family_id: int, flags: int, cmd: int, version: int):
-        super().__init__(family_id, 0, flags)
-
-        self.cmd = cmd
-        self.version = version
-        
-        self.append(self.__generate_header(), GenericNetLink.HEADER_LEN) # appends the generic header
-
-    def __generate_header(self) -> bytes:
-        """
-            Generates generic netlink header.
-            
-            Generic Netlink header is defined as followes:
-                cmd - 8 bits
-                version - 8 bits
-                not_used/reserved - 16 bits
-
-            @return the header in bytes.
-        """
-
-        return struct.pack("BBH", self.cmd, self.version, 0)
-    
-    @staticmethod
-    def from_message(message: Message):
-        """
-            Creates an generic message from an existing netlink message (Base Message).
-            
-            @param messsage src message.
-            @return Generic Message.
-        """
-
-        length, family_id, flags, seq, pid = message.parse_header()
-        cmd, version, _ = GenericMessage.parse_genl_header(message.get_bytes())
-        
-        genl_message = GenericMessage(family_id, flags, cmd, version)
-
-        genl_message.append(message.get_bytes()[NetLink.HEADER_LEN + GenericNetLink.HEADER_LEN:], 0) # adding payload.
-
-        return genl_message
-        
-    @staticmethod
-    def parse_genl_header(data: bytes) -> tuple[int, int, int]:
-        """
-            Parses the generic message's header (both parent and generic header).
-
-            Generic Netlink message:
-                16 bytes - is the netlink header, includes (length, type, flags, seq, pid).
-                4 bytes - is the generic netlink header, includes (cmd, version, reserved bytes/not used).
-                payload
-
-            @param data bytes message data.
-            @return a tuple that contains cmd, version, reserved bytes (you can ignore).
-
-        """
+CTRL_CMD_GETFAMILY = 3
+CTRL_ATTR_FAMILY_ID = 1
+CTRL_ATTR_FAMILY_NAME = 2
+CTRL_ATTR_VERSION = 3
+CTRL_ATTR_MAX = 10
 
-        header = data[NetLink.HEADER_LEN:NetLink.HEADER_LEN + GenericNetLink.HEADER_LEN]
-        return struct.unpack("BBH", header)
+NLM_F_REQUEST = 0x1
+NLM_F_DUMP = 0x300
 
 
-class GenericNetLink(NetLink):
+def ctrl_policies() -> list[AttributePolicy]:
     """
-        Simple and base implementation of the generic netlink.
+        The policies of the generic netlink controller (nlctrl) attributes.
     """
 
-    HEADER_LEN = 4
-    PROTOCOL = 16
+    policies = [AttributePolicy(Attribute.UNSPEC, 0, 0) for _ in range(CTRL_ATTR_MAX + 1)]
+    policies[CTRL_ATTR_FAMILY_ID] = AttributePolicy(Attribute.U16, 0, 0)
+    policies[CTRL_ATTR_FAMILY_NAME] = AttributePolicy(Attribute.STRING, 0, 0)
+    policies[CTRL_ATTR_VERSION] = AttributePolicy(Attribute.U32, 0, 0)
 
-    def __init__(self, family_name: str, policies: list[AttributePolicy]):
-        super().__init__(NetLink.resolve_genl_family_id(family_name), GenericNetLink.PROTOCOL, GenericNetLink.HEADER_LEN, policies)
+    return policies
 
-    def parse_message(self, msg: Message) -> tuple[list[Attribute], int, int]:
-        """
-            Parses a message (attributes + header).
-            For conviency later its receiving Message type.
 
-            @param msg message to parse
-            @return tuple of list of attributes, cmd and version.
-        """
+if __name__ == "__main__":
+    ctrl = GenericNetLink("nlctrl", ctrl_policies())
 
-        message = GenericMessage.from_message(msg)
-        
-        attributes = self.parse_message_attributes(message)
-        cmd, version = message.cmd, message.version
+    # lists the registered families.
+    for message in ctrl.dump(ctrl.message(CTRL_CMD_GETFAMILY, NLM_F_REQUEST | NLM_F_DUMP)):
+        attributes, cmd, version = ctrl.parse_message(message, True)
 
-        return attributes, cmd, version 
+        print("%-24s id: %-5d version: %d" % (attributes[CTRL_ATTR_FAMILY_NAME].decode(Attribute.STRING),
+                                              attributes[CTRL_ATTR_FAMILY_ID].decode(Attribute.U16),
+                                              attributes[CTRL_ATTR_VERSION].decode(Attribute.U32)))
@@ -0,0 +1,118 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+import threading
+import struct
+import time
+
+NETLINK_ROUTE = 0
+RTM_GETLINK = 18
+NLM_F_REQUEST = 0x1
+NLM_F_DUMP = 0x300
+
+DURATION = 2
+
+
+def count_progress(stop: threading.Event, result: list):
+    """
+        A pure python worker, counts how many iterations it managed to do.
+    """
+
+    counter = 0
+
+    while not stop.is_set():
+        counter += 1
+
+    result.append(counter)
+
+
+def saturate_socket(stop: threading.Event, result: list):
+    """
+        Keeps the socket busy by requesting link dumps and draining the replies.
+    """
+
+    netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+    messages = 0
+
+    while not stop.is_set():
+        message = Message(RTM_GETLINK, 0, NLM_F_REQUEST | NLM_F_DUMP)
+        message.append(struct.pack("Bxxxiii", 0, 0, 0, 0), 4) # struct ifinfomsg
+        netlink.send(message)
+
+        while True:
+            received, reads, _ = netlink.recv_many(0, 0, 0.1)
+            messages += len(received)
+
+            if not reads or received[-1].parse_header()[1] == 3: # NLMSG_DONE
+                break
+
+    netlink.close()
+    result.append(messages)
+
+
+def idle_wait(stop: threading.Event, result: list):
+    """
+        Blocks on a socket nobody sends to.
+    """
+
+    netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+
+    while not stop.is_set():
+        netlink.recv(0.1)
+
+    netlink.close()
+    result.append(0)
+
+
+def run(io_worker) -> tuple[int, int]:
+    """
+        Runs the counter alongside an I/O worker.
+
+        @param io_worker the I/O worker or None to run the counter alone.
+        @return tuple of the counter's iterations and the I/O worker result.
+    """
+
+    stop = threading.Event()
+    counter, io_result = [], []
+
+    threads = [threading.Thread(target=count_progress, args=(stop, counter))]
+    if io_worker is not None:
+        threads.append(threading.Thread(target=io_worker, args=(stop, io_result)))
+
+    for thread in threads:
+        thread.start()
+
+    time.sleep(DURATION)
+    stop.set()
+
+    for thread in threads:
+        thread.join()
+
+    return counter[0], io_result[0] if io_result else 0
+
+
+if __name__ == "__main__":
+    baseline, _ = run(None)
+    print("[+] Counter alone: %d iterations" % baseline)
+
+    iterations, _ = run(idle_wait)
+    print("[+] Counter next to a blocked recv: %d iterations (%.0f%%)" % (iterations, 100 * iterations / baseline))
+
+    iterations, messages = run(saturate_socket)
+    print("[+] Counter next to a saturated socket: %d iterations (%.0f%%), %d messages received" % (iterations, 100 * iterations / baseline, messages))
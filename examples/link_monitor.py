@@ -0,0 +1,99 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+import struct
+
+NETLINK_ROUTE = 0
+RTNLGRP_LINK = 1
+RTM_NEWLINK = 16
+RTM_DELLINK = 17
+RTM_GETLINK = 18
+NLM_F_REQUEST = 0x1
+NLM_F_DUMP = 0x300
+
+
+class LinkMonitor:
+    """
+        Keeps a table of the links up to date from the link events.
+
+        A burst of events can overrun the receive buffer, then the lost events leave the table stale.
+        The overrun callback marks the table dirty and the next poll rebuilds it with a dump.
+    """
+
+    def __init__(self, rcvbuf: int = 1 << 20):
+        self.links = {}
+        self.dirty = True
+
+        self.netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+        self.netlink.set_rcvbuf(rcvbuf)
+        self.netlink.set_overrun_callback(self.__on_overrun)
+        self.netlink.add_membership(RTNLGRP_LINK)
+
+    def poll(self, timeout: float = 1):
+        """
+            Applies the pending events, resyncing first if events were lost.
+
+            @param timeout seconds to wait for events.
+        """
+
+        if self.dirty:
+            self.resync()
+
+        messages, _, _ = self.netlink.recv_many(0, 0, timeout)
+
+        for message in messages:
+            self.__apply(message)
+
+    def resync(self):
+        """
+            Rebuilds the table with a link dump.
+        """
+
+        self.dirty = False
+        self.links.clear()
+
+        for message in self.netlink.dump(LinkMonitor.__get_links()):
+            self.__apply(message)
+
+    def __on_overrun(self, netlink: NetLink):
+        print("[!] receive buffer overran (%d so far), resyncing" % netlink.overruns)
+        self.dirty = True
+
+    def __apply(self, message: Message):
+        _, msg_type, _, _, _ = message.parse_header()
+        index, = struct.unpack_from("i", message.get_bytes(), NetLink.HEADER_LEN + 4) # ifinfomsg.ifi_index
+
+        if msg_type == RTM_NEWLINK:
+            self.links[index] = message
+        elif msg_type == RTM_DELLINK:
+            self.links.pop(index, None)
+
+    @staticmethod
+    def __get_links() -> Message:
+        message = Message(RTM_GETLINK, 0, NLM_F_REQUEST | NLM_F_DUMP)
+        message.append(struct.pack("Bxxxiii", 0, 0, 0, 0), 4) # struct ifinfomsg
+        return message
+
+
+if __name__ == "__main__":
+    monitor = LinkMonitor()
+
+    for _ in range(5):
+        monitor.poll()
+        print("[+] %d links" % len(monitor.links))
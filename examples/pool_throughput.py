@@ -0,0 +1,80 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLinkPool, Message
+import threading
+import struct
+import time
+
+NETLINK_ROUTE = 0
+RTM_GETLINK = 18
+NLM_F_REQUEST = 0x1
+
+REQUESTS_PER_THREAD = 2000
+BATCH = 50
+
+
+def get_link(index: int) -> Message:
+    message = Message(RTM_GETLINK, 0, NLM_F_REQUEST)
+    message.append(struct.pack("Bxxxiii", 0, index, 0, 0), 4) # struct ifinfomsg
+    return message
+
+
+def worker(pool: NetLinkPool, failures: list):
+    """
+        Sends its requests in pipelined batches, each batch runs on a socket leased for it.
+    """
+
+    for _ in range(REQUESTS_PER_THREAD // BATCH):
+        for error, _ in pool.pipeline([get_link(1) for _ in range(BATCH)], 1):
+            if error:
+                failures.append(error)
+
+
+def run(threads: int) -> float:
+    """
+        Runs the workers on a pool with a socket per thread.
+
+        @param threads number of threads.
+        @return requests per second.
+    """
+
+    pool = NetLinkPool(threads, 0, NETLINK_ROUTE, 0, [])
+    failures = []
+    workers = [threading.Thread(target=worker, args=(pool, failures)) for _ in range(threads)]
+
+    start = time.perf_counter()
+
+    for thread in workers:
+        thread.start()
+
+    for thread in workers:
+        thread.join()
+
+    elapsed = time.perf_counter() - start
+    pool.close()
+
+    if failures:
+        print("[!] %d requests failed" % len(failures))
+
+    return threads * REQUESTS_PER_THREAD / elapsed
+
+
+if __name__ == "__main__":
+    for threads in (1, 2, 4, 8):
+        print("[+] %d threads: %.0f requests/s" % (threads, run(threads)))
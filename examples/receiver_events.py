@@ -0,0 +1,81 @@
+"""
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+from netlink import NetLink, Message
+import asyncio
+
+NETLINK_ROUTE = 0
+RTNLGRP_LINK = 1
+RTNLGRP_IPV4_IFADDR = 5
+RTNLGRP_IPV4_ROUTE = 7
+
+
+async def get_batch(netlink: NetLink, max_msgs: int = 64) -> list[Message]:
+    """
+        Awaitable version of NetLink.get_batch.
+
+        The receiver's file descriptor is readable while its ring may have messages,
+        so the loop watches it instead of a thread blocking in get_batch.
+
+        @param netlink a netlink whose receiver is running.
+        @param max_msgs maximum number of messages.
+        @return the messages, at least one.
+    """
+
+    messages = netlink.get_batch(max_msgs, 0)
+
+    while not messages:
+        loop = asyncio.get_running_loop()
+        ready = loop.create_future()
+
+        loop.add_reader(netlink.receiver_fileno(), lambda: ready.done() or ready.set_result(None))
+
+        try:
+            await ready
+        finally:
+            loop.remove_reader(netlink.receiver_fileno())
+
+        messages = netlink.get_batch(max_msgs, 0)
+
+    return messages
+
+
+async def main():
+    netlink = NetLink(0, NETLINK_ROUTE, 0, [])
+
+    for group in (RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR, RTNLGRP_IPV4_ROUTE):
+        netlink.add_membership(group)
+
+    # the events are read by a native thread, a burst only has to fit in the ring.
+    netlink.start_receiver(8 << 20)
+
+    try:
+        while True:
+            for message in await get_batch(netlink):
+                length, msg_type, _, _, _ = message.parse_header()
+                print("[+] event type %d, %d bytes" % (msg_type, length))
+    finally:
+        print("[+] receiver counters:", netlink.receiver_stats())
+        netlink.close()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -15,7 +15,7 @@ setup(
             name="netlink",  # as it would be imported
             libraries=['nl-3', 'nl-genl-3'],
             include_dirs=['/usr/include/libnl3'],
-            sources=["src/main.c", "src/netlink.c", "src/netlink_class.c", "src/message.c", "src/attribute_policy.c", "src/attribute.c"], # all sources are compiled into a single binary file
+            sources=["src/main.c", "src/netlink.c", "src/netlink_class.c", "src/message.c", "src/message_pool.c", "src/attribute_policy.c", "src/attribute.c", "src/attribute_table.c", "src/pending.c", "src/dump.c", "src/genl_cache.c", "src/message_template.c", "src/generic_message.c", "src/generic_netlink.c", "src/stream.c", "src/receiver.c", "src/router.c", "src/filter.c", "src/ack.c", "src/rtnl_dump.c", "src/netlink_pool.c"], # all sources are compiled into a single binary file
         ),
     ]
 )
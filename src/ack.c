@@ -0,0 +1,157 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ack.h"
+#include <netlink/attr.h>
+#include <string.h>
+
+/**
+ * Parses an ack, with the extended ack's attributes when there are any.
+ *
+ * @param hdr The ack (NLMSG_ERROR).
+ * @return A new reference, NULL with an exception set upon failure (ValueError if hdr isn't a valid ack).
+ */
+Ack *ack_from_hdr(const struct nlmsghdr *hdr) {
+    const struct nlmsgerr *err = NLMSG_DATA(hdr);
+    struct nlattr *attrs[NLMSGERR_ATTR_MAX + 1] = {0};
+
+    if (hdr->nlmsg_type != NLMSG_ERROR || hdr->nlmsg_len < NLMSG_LENGTH(sizeof(*err))) {
+        PyErr_SetString(PyExc_ValueError, "Not an ack (NLMSG_ERROR)");
+        return NULL;
+    }
+
+    int capped = (hdr->nlmsg_flags & NLM_F_CAPPED) || err->msg.nlmsg_len < NLMSG_HDRLEN;
+    // the kernel puts the attributes right after the (aligned) echoed request.
+    size_t echoed = NLMSG_ALIGN(sizeof(*err) + (capped ? 0 : err->msg.nlmsg_len - NLMSG_HDRLEN));
+
+    if ((hdr->nlmsg_flags & NLM_F_ACK_TLVS) && NLMSG_LENGTH(echoed) < hdr->nlmsg_len) {
+        nla_parse(attrs, NLMSGERR_ATTR_MAX, (struct nlattr *) ((char *) err + echoed),
+                  hdr->nlmsg_len - NLMSG_LENGTH(echoed), NULL);
+    }
+
+    Ack *self = PyObject_New(Ack, &AckType);
+
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->error = err->error;
+    self->seq = err->msg.nlmsg_seq;
+    self->request_type = err->msg.nlmsg_type;
+    self->capped = capped;
+    self->msg = NULL;
+    self->offset = NULL;
+    self->cookie = NULL;
+    self->missing_type = NULL;
+
+    if (attrs[NLMSGERR_ATTR_MSG] != NULL) {
+        // the kernel's messages are null terminated, the length is bounded anyway.
+        self->msg = PyUnicode_DecodeUTF8(nla_data(attrs[NLMSGERR_ATTR_MSG]),
+                                         strnlen(nla_data(attrs[NLMSGERR_ATTR_MSG]), nla_len(attrs[NLMSGERR_ATTR_MSG])), "replace");
+    }
+
+    if (attrs[NLMSGERR_ATTR_OFFS] != NULL && nla_len(attrs[NLMSGERR_ATTR_OFFS]) >= 4) {
+        self->offset = PyLong_FromUnsignedLong(nla_get_u32(attrs[NLMSGERR_ATTR_OFFS]));
+    }
+
+    if (attrs[NLMSGERR_ATTR_COOKIE] != NULL) {
+        self->cookie = PyBytes_FromStringAndSize(nla_data(attrs[NLMSGERR_ATTR_COOKIE]), nla_len(attrs[NLMSGERR_ATTR_COOKIE]));
+    }
+
+    if (attrs[NLMSGERR_ATTR_MISS_TYPE] != NULL && nla_len(attrs[NLMSGERR_ATTR_MISS_TYPE]) >= 4) {
+        self->missing_type = PyLong_FromUnsignedLong(nla_get_u32(attrs[NLMSGERR_ATTR_MISS_TYPE]));
+    }
+
+    if ((attrs[NLMSGERR_ATTR_MSG] != NULL && self->msg == NULL) || (attrs[NLMSGERR_ATTR_COOKIE] != NULL && self->cookie == NULL)
+            || PyErr_Occurred()) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+static void Ack_dealloc(Ack *self) {
+    Py_XDECREF(self->msg);
+    Py_XDECREF(self->offset);
+    Py_XDECREF(self->cookie);
+    Py_XDECREF(self->missing_type);
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Ack_repr(Ack *self) {
+    if (self->msg != NULL) {
+        return PyUnicode_FromFormat("Ack(seq=%u, error=%d, msg=%R)", self->seq, self->error, self->msg);
+    }
+
+    return PyUnicode_FromFormat("Ack(seq=%u, error=%d)", self->seq, self->error);
+}
+
+static PyObject *Ack_get_ok(Ack *self, void *closure) {
+    return PyBool_FromLong(self->error == 0);
+}
+
+static PyMemberDef Ack_members[] = {
+    {"error", T_INT, offsetof(Ack, error), READONLY, "Zero upon success, a negative errno otherwise."},
+    {"seq", T_UINT, offsetof(Ack, seq), READONLY, "Sequence number of the acked request."},
+    {"request_type", T_INT, offsetof(Ack, request_type), READONLY, "nlmsg_type of the acked request."},
+    {"capped", T_BOOL, offsetof(Ack, capped), READONLY, "Whether only the request's header was echoed (NETLINK_CAP_ACK)."},
+    {"msg", T_OBJECT, offsetof(Ack, msg), READONLY, "The error message of the extended ack, None if none."},
+    {"offset", T_OBJECT, offsetof(Ack, offset), READONLY, "Offset of the invalid attribute in the request, None if none."},
+    {"cookie", T_OBJECT, offsetof(Ack, cookie), READONLY, "The cookie of the extended ack (bytes), None if none."},
+    {"missing_type", T_OBJECT, offsetof(Ack, missing_type), READONLY, "Type of a missing required attribute, None if none."},
+    {NULL} /* Sentinel */
+};
+
+static PyGetSetDef Ack_getset[] = {
+    {"ok", (getter) Ack_get_ok, NULL, "Whether the request succeeded.", NULL},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject AckType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.Ack", /* tp_name */
+    sizeof(Ack),                                      /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)Ack_dealloc,                          /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    (reprfunc)Ack_repr,                               /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                               /* tp_flags */
+    "The outcome of a request parsed from its ack, with the extended ack's details (see NetLink.set_ext_ack).", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    0,                      /* tp_iter */
+    0,                      /* tp_iternext */
+    0,                      /* tp_methods */
+    Ack_members,            /* tp_members */
+    Ack_getset,             /* tp_getset */
+};
@@ -0,0 +1,60 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACK_H
+#define ACK_H
+
+#include "Python.h"
+#include <structmember.h>
+#include <linux/netlink.h>
+
+/**
+ * The outcome of a request, parsed from its ack (NLMSG_ERROR).
+ *
+ * error -> Zero upon success, a negative errno otherwise.
+ * seq -> Sequence number of the acked request.
+ * request_type -> nlmsg_type of the acked request.
+ * capped -> Whether only the request's header was echoed (NETLINK_CAP_ACK).
+ * msg -> The extended ack's error message (NETLINK_EXT_ACK), NULL if none.
+ * offset -> Offset of the invalid attribute in the request, NULL if none.
+ * cookie -> The extended ack's cookie, NULL if none.
+ * missing_type -> Type of a missing required attribute, NULL if none.
+ */
+typedef struct {
+    PyObject_HEAD
+    int error;
+    unsigned int seq;
+    int request_type;
+    char capped;
+    PyObject *msg;
+    PyObject *offset;
+    PyObject *cookie;
+    PyObject *missing_type;
+} Ack;
+
+extern PyTypeObject AckType;
+
+/**
+ * Parses an ack, with the extended ack's attributes when there are any.
+ *
+ * @param hdr The ack (NLMSG_ERROR).
+ * @return A new reference, NULL with an exception set upon failure (ValueError if hdr isn't a valid ack).
+ */
+Ack *ack_from_hdr(const struct nlmsghdr *hdr);
+
+#endif
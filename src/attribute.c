@@ -18,8 +18,366 @@
 
 #include "attribute.h"
 
+/**
+ * Creates a new attribute from a parsed nlattr.
+ *
+ * @param nla The parsed attribute.
+ * @param owner The object that owns the nlattr's memory (exporting it through the buffer protocol),
+ *              the attribute becomes a view into it. NULL to copy the payload instead.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Attribute *attribute_from_nla(struct nlattr *nla, PyObject *owner) {
+	Attribute *attribute = PyObject_New(Attribute, &AttributeType);
+
+	if (attribute == NULL) {
+		return NULL;
+	}
+
+	attribute->len = nla_len(nla);
+	attribute->type = nla_type(nla);
+	attribute->owner = NULL;
+	attribute->data = NULL;
+
+	if (owner != NULL) {
+		// an export, so that the owner can't drop or replace its buffer while the view exists.
+		if (PyObject_GetBuffer(owner, &attribute->export, PyBUF_SIMPLE) < 0) {
+			Py_DECREF(attribute);
+			return NULL;
+		}
+
+		attribute->owner = attribute->export.obj;
+		attribute->data = nla_data(nla);
+		return attribute;
+	}
+
+	attribute->data = (unsigned char *) malloc(attribute->len > 0 ? attribute->len : 1);
+
+	if (attribute->data == NULL) {
+		Py_DECREF(attribute);
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	memcpy(attribute->data, nla_data(nla), attribute->len);
+
+	return attribute;
+}
+
+/**
+ * Decodes an attribute payload to a native python value according to a policy type.
+ *
+ * U8/U16/U32/U64/MSECS -> int, S8/S16/S32/S64 -> int, STRING/NUL_STRING -> str (up to the first null byte),
+ * FLAG -> True, anything else -> bytes.
+ *
+ * @param data The payload.
+ * @param len Length of the payload.
+ * @param policy_type The policy type (NLA_*).
+ * @return A new reference, NULL with an exception set upon failure (ValueError if the payload is too short).
+ */
+PyObject *attribute_decode(const void *data, int len, int policy_type) {
+	static const int sizes[] = {
+		[NLA_U8] = sizeof(uint8_t), [NLA_U16] = sizeof(uint16_t), [NLA_U32] = sizeof(uint32_t),
+		[NLA_U64] = sizeof(uint64_t), [NLA_MSECS] = sizeof(uint64_t),
+		[NLA_S8] = sizeof(int8_t), [NLA_S16] = sizeof(int16_t), [NLA_S32] = sizeof(int32_t), [NLA_S64] = sizeof(int64_t),
+	};
+
+	if (policy_type >= 0 && policy_type < (int) (sizeof(sizes) / sizeof(sizes[0])) && len < sizes[policy_type]) {
+		PyErr_Format(PyExc_ValueError, "Attribute payload too short (%d bytes) for its policy type %d", len, policy_type);
+		return NULL;
+	}
+
+	switch (policy_type) {
+	case NLA_U8:
+		return PyLong_FromUnsignedLong(*(const uint8_t *) data);
+	case NLA_U16:
+		return PyLong_FromUnsignedLong(*(const uint16_t *) data);
+	case NLA_U32:
+		return PyLong_FromUnsignedLong(*(const uint32_t *) data);
+	case NLA_U64:
+	case NLA_MSECS: {
+		uint64_t value;
+		// 64 bit attributes are only 4 bytes aligned.
+		memcpy(&value, data, sizeof(value));
+		return PyLong_FromUnsignedLongLong(value);
+	}
+	case NLA_S8:
+		return PyLong_FromLong(*(const int8_t *) data);
+	case NLA_S16:
+		return PyLong_FromLong(*(const int16_t *) data);
+	case NLA_S32:
+		return PyLong_FromLong(*(const int32_t *) data);
+	case NLA_S64: {
+		int64_t value;
+		memcpy(&value, data, sizeof(value));
+		return PyLong_FromLongLong(value);
+	}
+	case NLA_STRING:
+	case NLA_NUL_STRING:
+		return PyUnicode_DecodeUTF8((const char *) data, strnlen((const char *) data, len), "surrogateescape");
+	case NLA_FLAG:
+		Py_RETURN_TRUE;
+	default:
+		return PyBytes_FromStringAndSize((const char *) data, len);
+	}
+}
+
+/**
+ * Stores the low size bytes of an integer (native byte order).
+ */
+static void store_integer(void *payload, int size, uint64_t value) {
+	uint8_t u8 = value;
+	uint16_t u16 = value;
+	uint32_t u32 = value;
+
+	switch (size) {
+	case 1: memcpy(payload, &u8, size); break;
+	case 2: memcpy(payload, &u16, size); break;
+	case 4: memcpy(payload, &u32, size); break;
+	default: memcpy(payload, &value, size); break;
+	}
+}
+
+/**
+ * Converts a python int to an integer attribute payload, checking it fits.
+ *
+ * @param value The int.
+ * @param size Size of the payload (1, 2, 4 or 8).
+ * @param is_signed Whether the payload is signed.
+ * @param payload Filled with the payload (native byte order).
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int integer_payload(PyObject *value, int size, int is_signed, void *payload) {
+	int bits = size * 8;
+
+	if (!PyLong_Check(value)) {
+		PyErr_Format(PyExc_TypeError, "Integer attributes take an int, not %.100s", Py_TYPE(value)->tp_name);
+		return -1;
+	}
+
+	if (is_signed) {
+		long long number = PyLong_AsLongLong(value);
+
+		if (number == -1 && PyErr_Occurred()) {
+			return -1;
+		}
+
+		if (bits < 64 && (number < -(1LL << (bits - 1)) || number >= (1LL << (bits - 1)))) {
+			PyErr_Format(PyExc_OverflowError, "%lld doesn't fit in a signed %d bit attribute", number, bits);
+			return -1;
+		}
+
+		store_integer(payload, size, (uint64_t) number);
+	} else {
+		unsigned long long number = PyLong_AsUnsignedLongLong(value);
+
+		if (number == (unsigned long long) -1 && PyErr_Occurred()) {
+			return -1;
+		}
+
+		if (bits < 64 && number >= (1ULL << bits)) {
+			PyErr_Format(PyExc_OverflowError, "%llu doesn't fit in an unsigned %d bit attribute", number, bits);
+			return -1;
+		}
+
+		store_integer(payload, size, number);
+	}
+
+	return 0;
+}
+
+/**
+ * Encodes a native python value as an attribute according to a policy type (the reverse of attribute_decode).
+ *
+ * U8/U16/U32/U64/MSECS, S8/S16/S32/S64 <- int (range checked), STRING/NUL_STRING <- str,
+ * FLAG <- any value (put only if true), anything else <- bytes-like.
+ *
+ * @param msg The message to append to.
+ * @param type The attribute type.
+ * @param policy_type The policy type (NLA_*).
+ * @param value The value.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+int attribute_encode(struct nl_msg *msg, int type, int policy_type, PyObject *value) {
+	unsigned char payload[8];
+	int size = 0;
+	int is_signed = 0;
+	int ret;
+
+	switch (policy_type) {
+	case NLA_U8: size = 1; break;
+	case NLA_U16: size = 2; break;
+	case NLA_U32: size = 4; break;
+	case NLA_U64:
+	case NLA_MSECS: size = 8; break;
+	case NLA_S8: size = 1; is_signed = 1; break;
+	case NLA_S16: size = 2; is_signed = 1; break;
+	case NLA_S32: size = 4; is_signed = 1; break;
+	case NLA_S64: size = 8; is_signed = 1; break;
+	}
+
+	if (size > 0) {
+		if (integer_payload(value, size, is_signed, payload) < 0) {
+			return -1;
+		}
+
+		ret = nla_put(msg, type, size, payload);
+	} else if (policy_type == NLA_STRING || policy_type == NLA_NUL_STRING) {
+		if (!PyUnicode_Check(value)) {
+			PyErr_Format(PyExc_TypeError, "String attributes take a str, not %.100s", Py_TYPE(value)->tp_name);
+			return -1;
+		}
+
+		const char *string = PyUnicode_AsUTF8(value);
+
+		if (string == NULL) {
+			return -1;
+		}
+
+		ret = nla_put_string(msg, type, string);
+	} else if (policy_type == NLA_FLAG) {
+		int set = PyObject_IsTrue(value);
+
+		if (set < 0) {
+			return -1;
+		}
+
+		ret = set ? nla_put_flag(msg, type) : 0;
+	} else {
+		Py_buffer buffer;
+
+		if (PyObject_GetBuffer(value, &buffer, PyBUF_SIMPLE) < 0) {
+			return -1;
+		}
+
+		ret = nla_put(msg, type, buffer.len, buffer.buf);
+		PyBuffer_Release(&buffer);
+	}
+
+	if (ret < 0) {
+		PyErr_Format(PyExc_MemoryError, "Not enough room in the message for attribute %d", type);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Parses the children of a nested attribute.
+ *
+ * @param nla The nested attribute.
+ * @param policy The policies of the children.
+ * @return A newly allocated index of policy->maxtype+1 entries (the caller frees it), NULL with an exception set upon failure.
+ */
+struct nlattr **nested_parse(struct nlattr *nla, struct policy_table *policy) {
+	struct nlattr **attrs = calloc(policy->maxtype + 1, sizeof(struct nlattr *));
+	int ret;
+
+	if (attrs == NULL) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	if ((ret = nla_parse_nested(attrs, policy->maxtype, nla, policy->policies)) < 0) {
+		free(attrs);
+		PyErr_Format(PyExc_ValueError, "Failed to parse the nested attribute %d: %s", nla_type(nla), nl_geterror(ret));
+		return NULL;
+	}
+
+	return attrs;
+}
+
+/**
+ * Decodes the children of a nested attribute to a dict of type -> native value.
+ */
+static PyObject *nested_decode(struct nlattr *nla, struct policy_table *policy) {
+	struct nlattr **attrs = nested_parse(nla, policy);
+
+	if (attrs == NULL) {
+		return NULL;
+	}
+
+	PyObject *values = attributes_decode(attrs, policy);
+	free(attrs);
+
+	return values;
+}
+
+/**
+ * Decodes a parsed attributes index to a dict of type -> native value, in one pass.
+ * NESTED attributes whose policy has child policies are decoded recursively to dicts.
+ *
+ * @param attrs The index filled by nlmsg_parse, policy->maxtype+1 entries.
+ * @param policy The policies the attributes were parsed with.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+PyObject *attributes_decode(struct nlattr **attrs, struct policy_table *policy) {
+	PyObject *values = PyDict_New();
+
+	if (values == NULL) {
+		return NULL;
+	}
+
+	for (int i = 0; i <= policy->maxtype; i++) {
+		if (!attrs[i]) continue;
+
+		PyObject *type = PyLong_FromLong(i);
+		PyObject *value;
+
+		if (policy->nested[i] != NULL) {
+			value = nested_decode(attrs[i], policy->nested[i]);
+		} else {
+			value = attribute_decode(nla_data(attrs[i]), nla_len(attrs[i]), policy->policies[i].type);
+		}
+
+		if (type == NULL || value == NULL || PyDict_SetItem(values, type, value) < 0) {
+			Py_XDECREF(type);
+			Py_XDECREF(value);
+			Py_DECREF(values);
+			return NULL;
+		}
+
+		Py_DECREF(type);
+		Py_DECREF(value);
+	}
+
+	return values;
+}
+
+#define decode_docs "Decodes the payload to a native value.\n@param type Policy type to decode with (Attribute.U8, Attribute.STRING...)\n@return int, str, True (FLAG) or bytes (any other type)"
+
+static PyObject *attribute_decode_method(Attribute *self, PyObject *args) {
+	int type;
+
+	if (!PyArg_ParseTuple(args, "i", &type)) {
+		return NULL;
+	}
+
+	return attribute_decode(self->data, self->len, type);
+}
+
+#define get_data_bytes_docs "@return a copy of the attribute's payload in bytes"
+
 static PyObject *get_data_bytes(Attribute *self, PyObject * args) {
-	return PyBytes_FromStringAndSize(self->data, self->len);
+	return PyBytes_FromStringAndSize((char *) self->data, self->len);
+}
+
+/**
+ * Getter of the data member.
+ * Decodes the payload as a string, stopping at the first null byte (if any).
+ */
+static PyObject *Attribute_get_data(Attribute *self, void *closure) {
+	if (self->data == NULL) {
+		Py_RETURN_NONE;
+	}
+
+	return PyUnicode_DecodeUTF8((char *) self->data, strnlen((char *) self->data, self->len), NULL);
+}
+
+/**
+ * Buffer protocol, exposes the payload without copying it.
+ */
+static int Attribute_getbuffer(Attribute *self, Py_buffer *view, int flags) {
+	return PyBuffer_FillInfo(view, (PyObject *) self, self->data, self->len, 1, flags);
 }
 
 static PyObject *Attribute_new(PyTypeObject *type, PyObject *args,
@@ -32,40 +390,53 @@ static PyObject *Attribute_new(PyTypeObject *type, PyObject *args,
 }
 
 static void Attribute_dealloc(Attribute *self) {
-	if (self->data != NULL) {
+	if (self->owner != NULL) {
+		PyBuffer_Release(&self->export);
+	} else if (self->data != NULL) {
 		free(self->data);
 	}
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-static void Attribute_init(Attribute *self, PyObject *args, PyObject *kwds) {
+static int Attribute_init(Attribute *self, PyObject *args, PyObject *kwds) {
     Py_buffer data;
     int len;
     int type;
 
-    if (!PyArg_ParseTuple(args, "y*ii", &data, &len, &type)) return;
+    if (!PyArg_ParseTuple(args, "y*ii", &data, &len, &type)) return -1;
 
     self->data = (unsigned char *) malloc(data.len);
     memcpy(self->data, data.buf, data.len);
-    self->len = len;
+    self->len = len < data.len ? len : data.len;
     self->type = type;
 
     PyBuffer_Release(&data);
-    return;
+    return 0;
 }
 
 static PyMemberDef Attribute_members[] = {
     {"len", T_INT, offsetof(Attribute, len), 0, "The netlink."},
     {"type", T_INT, offsetof(Attribute, type), 0, "The netlink."},
-    {"data", T_STRING, offsetof(Attribute, data), 0, "The netlink."},
+    {"owner", T_OBJECT, offsetof(Attribute, owner), READONLY, "The object whose buffer the attribute views, None if the attribute owns a copy."},
+    {NULL} /* Sentinel */
+};
+
+static PyGetSetDef Attribute_getset[] = {
+    {"data", (getter) Attribute_get_data, NULL, "The payload as a string.", NULL},
     {NULL} /* Sentinel */
 };
 
 static PyMethodDef Attribute_methods[] = {
-	{"get_data_bytes",  (PyCFunction) get_data_bytes, METH_VARARGS, ""},
+	{"get_data_bytes",  (PyCFunction) get_data_bytes, METH_VARARGS, get_data_bytes_docs},
+	{"decode",  (PyCFunction) attribute_decode_method, METH_VARARGS, decode_docs},
        {NULL} /* Sentinel */
 };
 
+static PyBufferProcs Attribute_as_buffer = {
+    (getbufferproc) Attribute_getbuffer, /* bf_getbuffer */
+    0,                                   /* bf_releasebuffer */
+};
+
 PyTypeObject AttributeType = {
     PyVarObject_HEAD_INIT(NULL, 0) "netlink.Attribute", /* tp_name */
     sizeof(Attribute),                                  /* tp_basicsize */
@@ -84,7 +455,7 @@ PyTypeObject AttributeType = {
     0,                                                /* tp_str */
     0,                                                /* tp_getattro */
     0,                                                /* tp_setattro */
-    0,                                                /* tp_as_buffer */
+    &Attribute_as_buffer,                             /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,                               /* tp_flags */
     "Client implmentation of the netlink kenrel interface.", /* tp_doc */
     0,                                                       /* tp_traverse */
@@ -95,7 +466,7 @@ PyTypeObject AttributeType = {
     0,                      /* tp_iternext */
     Attribute_methods,        /* tp_methods */
     Attribute_members,        /* tp_members */
-    0,                      /* tp_getset */
+    Attribute_getset,       /* tp_getset */
     0,                      /* tp_base */
     0,                      /* tp_dict */
     0,                      /* tp_descr_get */
@@ -22,17 +22,82 @@
 #include "Python.h"
 #include <structmember.h>
 #include "netlink.h"
+#include "attribute_policy.h"
 
 /**
  * Represents NetLink class.
+ *
+ * data -> The attribute's payload.
+ * len -> Length of the payload.
+ * type -> The attribute's type.
+ * owner -> In view mode the object whose buffer data points into (export.obj), otherwise NULL and data is owned by the attribute.
+ * export -> In view mode the buffer export that keeps data valid (the owner can't replace its buffer while it's held).
  */
 typedef struct {
     PyObject_HEAD
     unsigned char *data;
     int len;
     int type;
+    PyObject *owner;
+    Py_buffer export;
 } Attribute; 
 
 extern PyTypeObject AttributeType;
 
+/**
+ * Creates a new attribute from a parsed nlattr.
+ *
+ * @param nla The parsed attribute.
+ * @param owner The object that owns the nlattr's memory (exporting it through the buffer protocol),
+ *              the attribute becomes a view into it. NULL to copy the payload instead.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Attribute *attribute_from_nla(struct nlattr *nla, PyObject *owner);
+
+/**
+ * Decodes an attribute payload to a native python value according to a policy type.
+ *
+ * U8/U16/U32/U64/MSECS -> int, S8/S16/S32/S64 -> int, STRING/NUL_STRING -> str (up to the first null byte),
+ * FLAG -> True, anything else -> bytes.
+ *
+ * @param data The payload.
+ * @param len Length of the payload.
+ * @param policy_type The policy type (NLA_*).
+ * @return A new reference, NULL with an exception set upon failure (ValueError if the payload is too short).
+ */
+PyObject *attribute_decode(const void *data, int len, int policy_type);
+
+/**
+ * Encodes a native python value as an attribute according to a policy type (the reverse of attribute_decode).
+ *
+ * U8/U16/U32/U64/MSECS, S8/S16/S32/S64 <- int (range checked), STRING/NUL_STRING <- str,
+ * FLAG <- any value (put only if true), anything else <- bytes-like.
+ *
+ * @param msg The message to append to.
+ * @param type The attribute type.
+ * @param policy_type The policy type (NLA_*).
+ * @param value The value.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+int attribute_encode(struct nl_msg *msg, int type, int policy_type, PyObject *value);
+
+/**
+ * Parses the children of a nested attribute.
+ *
+ * @param nla The nested attribute.
+ * @param policy The policies of the children.
+ * @return A newly allocated index of policy->maxtype+1 entries (the caller frees it), NULL with an exception set upon failure.
+ */
+struct nlattr **nested_parse(struct nlattr *nla, struct policy_table *policy);
+
+/**
+ * Decodes a parsed attributes index to a dict of type -> native value, in one pass.
+ * NESTED attributes whose policy has child policies are decoded recursively to dicts.
+ *
+ * @param attrs The index filled by nlmsg_parse, policy->maxtype+1 entries.
+ * @param policy The policies the attributes were parsed with.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+PyObject *attributes_decode(struct nlattr **attrs, struct policy_table *policy);
+
 #endif
@@ -18,6 +18,109 @@
 
 #include "attribute_policy.h"
 
+/**
+ * Builds a policy table, depth counts the nesting levels above it.
+ */
+static struct policy_table *policy_table_build(PyObject *policies, int depth) {
+    if (depth >= POLICY_MAX_DEPTH) {
+        PyErr_SetString(PyExc_ValueError, "Nested policies are too deep (is a policy list nested in itself?)");
+        return NULL;
+    }
+
+    if (!PyList_Check(policies)) {
+        PyErr_SetString(PyExc_TypeError, "Policies must be a list");
+        return NULL;
+    }
+
+    struct policy_table *table = calloc(1, sizeof(struct policy_table));
+
+    if (table == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    table->refcount = 1;
+    table->maxtype = PyList_GET_SIZE(policies);
+    // nla_parse indexes the policies by attribute type up to maxtype (inclusive).
+    table->policies = calloc(table->maxtype + 1, sizeof(struct nla_policy));
+    table->nested = calloc(table->maxtype + 1, sizeof(struct policy_table *));
+
+    if (table->policies == NULL || table->nested == NULL) {
+        policy_table_unref(table);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (int i = 0; i < table->maxtype; i++) {
+        PyObject *item = PyList_GET_ITEM(policies, i);
+
+        if (!PyObject_TypeCheck(item, &AttributePolicyType)) {
+            policy_table_unref(table);
+            PyErr_SetString(PyExc_TypeError, "List must contain AttributePolicy");
+            return NULL;
+        }
+
+        AttributePolicy *policy = (AttributePolicy *) item;
+        table->policies[i] = policy->policy;
+
+        if (policy->nested != NULL && policy->nested != Py_None) {
+            table->nested[i] = policy_table_build(policy->nested, depth + 1);
+
+            if (table->nested[i] == NULL) {
+                policy_table_unref(table);
+                return NULL;
+            }
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Builds a policy table (recursively) from a list of AttributePolicy, the list index is the attribute type.
+ *
+ * @param policies The list.
+ * @return A new table (one reference), NULL with an exception set upon failure.
+ */
+struct policy_table *policy_table_from_list(PyObject *policies) {
+    return policy_table_build(policies, 0);
+}
+
+/**
+ * Takes a reference to a policy table.
+ *
+ * @param table The table, may be NULL.
+ * @return The table.
+ */
+struct policy_table *policy_table_ref(struct policy_table *table) {
+    if (table != NULL) {
+        table->refcount++;
+    }
+
+    return table;
+}
+
+/**
+ * Drops a reference to a policy table, the table and its children are freed with the last one.
+ *
+ * @param table The table, may be NULL.
+ */
+void policy_table_unref(struct policy_table *table) {
+    if (table == NULL || --table->refcount > 0) {
+        return;
+    }
+
+    if (table->nested != NULL) {
+        for (int i = 0; i <= table->maxtype; i++) {
+            policy_table_unref(table->nested[i]);
+        }
+    }
+
+    free(table->nested);
+    free(table->policies);
+    free(table);
+}
+
 static PyObject *AttributePolicy_new(PyTypeObject *type, PyObject *args,
                              PyObject *kwds) {
     AttributePolicy *self;
@@ -28,6 +131,7 @@ static PyObject *AttributePolicy_new(PyTypeObject *type, PyObject *args,
 }
 
 static void AttributePolicy_dealloc(AttributePolicy *self) {
+    Py_XDECREF(self->nested);
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -37,26 +141,43 @@ static void AttributePolicy_dealloc(AttributePolicy *self) {
  * @param type The type of the attribute.
  * @param minlen The min length of the attribute.
  * @param maxlen The max length of the attribute.
+ * @param nested The policies of the children (list of AttributePolicy indexed by type), for NESTED attributes.
  */
-static void AttributePolicy_init(AttributePolicy *self, PyObject *args, PyObject *kwds) {
-    static char *kwlist[] = {"type", "minlen", "maxlen"};
+static int AttributePolicy_init(AttributePolicy *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"type", "minlen", "maxlen", "nested", NULL};
+    PyObject *nested = NULL;
     int type;
     int minlen;
     int maxlen;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iii", kwlist, &type, &minlen, &maxlen)) return;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iii|O", kwlist, &type, &minlen, &maxlen, &nested)) return -1;
+
+    if (nested == Py_None) {
+        nested = NULL;
+    }
+
+    if (nested != NULL && !PyList_Check(nested)) {
+        PyErr_SetString(PyExc_TypeError, "nested must be a list of AttributePolicy");
+        return -1;
+    }
+
+    Py_XINCREF(nested);
+    Py_XSETREF(self->nested, nested);
 
     self->policy = (struct nla_policy) {
         .type = type,
         .minlen = minlen,
         .maxlen = maxlen,
     };
+
+    return 0;
 }
 
 static PyMemberDef AttributePolicy_members[] = {
-    {"type", T_INT, offsetof(AttributePolicy, policy.type), 0, "Type of the attribute."},
-    {"minlen", T_INT, offsetof(AttributePolicy, policy.minlen), 0, "Minimum length of the attribute."},
-    {"maxlen", T_INT, offsetof(AttributePolicy, policy.maxlen), 0, "Maximum length of the attribute."},
+    {"type", T_USHORT, offsetof(AttributePolicy, policy.type), 0, "Type of the attribute."},
+    {"minlen", T_USHORT, offsetof(AttributePolicy, policy.minlen), 0, "Minimum length of the attribute."},
+    {"maxlen", T_USHORT, offsetof(AttributePolicy, policy.maxlen), 0, "Maximum length of the attribute."},
+    {"nested", T_OBJECT, offsetof(AttributePolicy, nested), READONLY, "The policies of the children (NESTED attributes), None if none."},
     {NULL} /* Sentinel */
 };
 
@@ -35,14 +35,60 @@
 #include <string.h>
 
 
+// nested policies deeper than this are refused, it also stops cyclic policy lists.
+#define POLICY_MAX_DEPTH 16
+
 /**
  * Represents NetLink class.
+ *
+ * policy -> The libnl policy.
+ * nested -> List of the policies of the children (NESTED attributes only), NULL if none.
  */
 typedef struct {
     PyObject_HEAD
     struct nla_policy policy;
+    PyObject *nested;
 } AttributePolicy; 
 
 extern PyTypeObject AttributePolicyType;
 
+/**
+ * A table of policies indexed by attribute type, with the tables of the nested attributes.
+ * Doesn't reference any python object, tables are shared by reference counting (under the GIL).
+ *
+ * refcount -> Number of references.
+ * maxtype -> The highest attribute type.
+ * policies -> The libnl policies, maxtype+1 entries.
+ * nested -> The child table of every NESTED attribute that has one (NULL otherwise), maxtype+1 entries.
+ */
+struct policy_table {
+    int refcount;
+    int maxtype;
+    struct nla_policy *policies;
+    struct policy_table **nested;
+};
+
+/**
+ * Builds a policy table (recursively) from a list of AttributePolicy, the list index is the attribute type.
+ *
+ * @param policies The list.
+ * @return A new table (one reference), NULL with an exception set upon failure.
+ */
+struct policy_table *policy_table_from_list(PyObject *policies);
+
+/**
+ * Takes a reference to a policy table.
+ *
+ * @param table The table, may be NULL.
+ * @return The table.
+ */
+struct policy_table *policy_table_ref(struct policy_table *table);
+
+/**
+ * Drops a reference to a policy table, the table and its children are freed with the last one.
+ *
+ * @param table The table, may be NULL.
+ */
+void policy_table_unref(struct policy_table *table);
+
 #endif
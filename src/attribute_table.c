@@ -0,0 +1,332 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "attribute_table.h"
+
+/**
+ * Creates a new empty attribute table, the caller fills the attrs index.
+ *
+ * @param owner The object that owns the attributes memory, exporting it through the buffer protocol.
+ * @param policy The policies the attributes are parsed with, its maxtype is the table's.
+ * @param view Whether the attributes created by the table are views or copies.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+AttributeTable *attribute_table_new(PyObject *owner, struct policy_table *policy, int view) {
+	AttributeTable *table = PyObject_New(AttributeTable, &AttributeTableType);
+
+	if (table == NULL) {
+		return NULL;
+	}
+
+	table->owner = NULL;
+	table->policy = policy_table_ref(policy);
+	table->maxtype = policy->maxtype;
+	table->view = view;
+	table->attrs = NULL;
+	table->cache = NULL;
+
+	// the attrs index points into the buffer, it must stay exported as long as the table exists.
+	if (PyObject_GetBuffer(owner, &table->export, PyBUF_SIMPLE) < 0) {
+		Py_DECREF(table);
+		return NULL;
+	}
+
+	table->owner = table->export.obj;
+	table->attrs = calloc(table->maxtype + 1, sizeof(struct nlattr *));
+	table->cache = calloc(table->maxtype + 1, sizeof(PyObject *));
+
+	if (table->attrs == NULL || table->cache == NULL) {
+		Py_DECREF(table);
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	return table;
+}
+
+/**
+ * Converts a python key to an attribute type.
+ *
+ * @param key The key.
+ * @return The type, or -1 if the key isn't a type the table holds (an exception is set only if the key isn't an int).
+ */
+static int table_key_to_type(AttributeTable *self, PyObject *key) {
+	long type = PyLong_AsLong(key);
+
+	if (type == -1 && PyErr_Occurred()) {
+		return -1;
+	}
+
+	if (type < 0 || type > self->maxtype || self->attrs[type] == NULL) {
+		return -1;
+	}
+
+	return (int) type;
+}
+
+/**
+ * Creates the table of a nested attribute's children.
+ *
+ * @param type An existing type with child policies.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+static PyObject *table_new_nested(AttributeTable *self, int type) {
+	AttributeTable *table = attribute_table_new(self->owner, self->policy->nested[type], self->view);
+
+	if (table == NULL) {
+		return NULL;
+	}
+
+	struct nlattr **attrs = nested_parse(self->attrs[type], self->policy->nested[type]);
+
+	if (attrs == NULL) {
+		Py_DECREF(table);
+		return NULL;
+	}
+
+	free(table->attrs);
+	table->attrs = attrs;
+
+	return (PyObject *) table;
+}
+
+/**
+ * Returns the attribute of a type, creating it on first access.
+ * A NESTED attribute with child policies is returned as the table of its children.
+ *
+ * @param type An existing type.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+static PyObject *table_get_attribute(AttributeTable *self, int type) {
+	if (self->cache[type] == NULL) {
+		if (self->policy->nested[type] != NULL) {
+			self->cache[type] = table_new_nested(self, type);
+		} else {
+			self->cache[type] = (PyObject *) attribute_from_nla(self->attrs[type], self->view ? self->owner : NULL);
+		}
+
+		if (self->cache[type] == NULL) {
+			return NULL;
+		}
+	}
+
+	Py_INCREF(self->cache[type]);
+	return self->cache[type];
+}
+
+#define get_docs "Returns the attribute of a type.\n@param type The attribute type\n@param default Returned if the attribute is missing (default None)\n@return The attribute (Attribute)"
+
+static PyObject *attribute_table_get(AttributeTable *self, PyObject *args) {
+	PyObject *key;
+	PyObject *default_value = Py_None;
+
+	if (!PyArg_ParseTuple(args, "O|O", &key, &default_value)) {
+		return NULL;
+	}
+
+	int type = table_key_to_type(self, key);
+
+	if (type < 0) {
+		if (PyErr_Occurred()) {
+			return NULL;
+		}
+
+		Py_INCREF(default_value);
+		return default_value;
+	}
+
+	return table_get_attribute(self, type);
+}
+
+#define decode_docs "Decodes every attribute to a native value according to its policy (see Attribute.decode), nested tables are decoded recursively.\n@return dict of type to value"
+
+static PyObject *attribute_table_decode(AttributeTable *self, PyObject *args) {
+	return attributes_decode(self->attrs, self->policy);
+}
+
+#define types_docs "@return The types of the attributes in the table, in ascending order (list[int])"
+
+static PyObject *attribute_table_types(AttributeTable *self, PyObject *args) {
+	PyObject *types = PyList_New(0);
+
+	if (types == NULL) {
+		return NULL;
+	}
+
+	for (int i = 0; i <= self->maxtype; i++) {
+		if (!self->attrs[i]) continue;
+
+		PyObject *type = PyLong_FromLong(i);
+
+		if (type == NULL || PyList_Append(types, type) < 0) {
+			Py_XDECREF(type);
+			Py_DECREF(types);
+			return NULL;
+		}
+
+		Py_DECREF(type);
+	}
+
+	return types;
+}
+
+static PyObject *AttributeTable_subscript(AttributeTable *self, PyObject *key) {
+	int type = table_key_to_type(self, key);
+
+	if (type < 0) {
+		if (!PyErr_Occurred()) {
+			PyErr_SetObject(PyExc_KeyError, key);
+		}
+
+		return NULL;
+	}
+
+	return table_get_attribute(self, type);
+}
+
+static int AttributeTable_contains(AttributeTable *self, PyObject *key) {
+	int type = table_key_to_type(self, key);
+
+	if (type < 0) {
+		if (PyErr_Occurred()) {
+			if (!PyErr_ExceptionMatches(PyExc_TypeError)) {
+				return -1;
+			}
+
+			PyErr_Clear();
+		}
+
+		return 0;
+	}
+
+	return 1;
+}
+
+static Py_ssize_t AttributeTable_length(AttributeTable *self) {
+	Py_ssize_t count = 0;
+
+	for (int i = 0; i <= self->maxtype; i++) {
+		if (self->attrs[i]) count++;
+	}
+
+	return count;
+}
+
+/**
+ * Iterates over the attributes (not the types) in ascending type order.
+ */
+static PyObject *AttributeTable_iter(AttributeTable *self) {
+	PyObject *attributes = PyList_New(0);
+
+	if (attributes == NULL) {
+		return NULL;
+	}
+
+	for (int i = 0; i <= self->maxtype; i++) {
+		if (!self->attrs[i]) continue;
+
+		PyObject *attribute = table_get_attribute(self, i);
+
+		if (attribute == NULL || PyList_Append(attributes, attribute) < 0) {
+			Py_XDECREF(attribute);
+			Py_DECREF(attributes);
+			return NULL;
+		}
+
+		Py_DECREF(attribute);
+	}
+
+	PyObject *iterator = PyObject_GetIter(attributes);
+	Py_DECREF(attributes);
+
+	return iterator;
+}
+
+static void AttributeTable_dealloc(AttributeTable *self) {
+	if (self->cache != NULL) {
+		for (int i = 0; i <= self->maxtype; i++) {
+			Py_XDECREF(self->cache[i]);
+		}
+
+		free(self->cache);
+	}
+
+	free(self->attrs);
+	policy_table_unref(self->policy);
+
+	if (self->owner != NULL) {
+		PyBuffer_Release(&self->export);
+	}
+
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMemberDef AttributeTable_members[] = {
+    {"owner", T_OBJECT, offsetof(AttributeTable, owner), READONLY, "The object that owns the attributes."},
+    {"maxtype", T_INT, offsetof(AttributeTable, maxtype), READONLY, "The highest attribute type the table can hold."},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef AttributeTable_methods[] = {
+    {"get", (PyCFunction) attribute_table_get, METH_VARARGS, get_docs},
+    {"types", (PyCFunction) attribute_table_types, METH_NOARGS, types_docs},
+    {"decode", (PyCFunction) attribute_table_decode, METH_NOARGS, decode_docs},
+    {NULL} /* Sentinel */
+};
+
+static PyMappingMethods AttributeTable_as_mapping = {
+    (lenfunc) AttributeTable_length,         /* mp_length */
+    (binaryfunc) AttributeTable_subscript,   /* mp_subscript */
+    0,                                       /* mp_ass_subscript */
+};
+
+static PySequenceMethods AttributeTable_as_sequence = {
+    .sq_length = (lenfunc) AttributeTable_length,
+    .sq_contains = (objobjproc) AttributeTable_contains,
+};
+
+PyTypeObject AttributeTableType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.AttributeTable", /* tp_name */
+    sizeof(AttributeTable),                           /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)AttributeTable_dealloc,               /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    &AttributeTable_as_sequence,                      /* tp_as_sequence */
+    &AttributeTable_as_mapping,                       /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                               /* tp_flags */
+    "Parsed attributes of a message indexed by type, Attribute objects (and the tables of nested attributes) are created on first access.", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    (getiterfunc)AttributeTable_iter, /* tp_iter */
+    0,                      /* tp_iternext */
+    AttributeTable_methods, /* tp_methods */
+    AttributeTable_members, /* tp_members */
+};
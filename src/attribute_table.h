@@ -0,0 +1,62 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ATTRIBUTE_TABLE_H
+#define ATTRIBUTE_TABLE_H
+
+#include "Python.h"
+#include <structmember.h>
+#include "netlink.h"
+#include "attribute.h"
+
+/**
+ * Represents the parsed attributes of a message, indexed by type.
+ *
+ * owner -> The object that owns the attributes memory (export.obj).
+ * export -> The buffer export that keeps the attributes valid (the owner can't replace its buffer while it's held).
+ * policy -> The policies the attributes were parsed with (referenced by the table).
+ * maxtype -> The highest attribute type the table can hold.
+ * view -> Whether the created Attribute objects are views or copies.
+ * attrs -> The nlattr index filled by nlmsg_parse, maxtype+1 entries.
+ * cache -> The objects created so far, maxtype+1 entries. An Attribute, or for a NESTED attribute
+ *          with child policies the AttributeTable of its children.
+ */
+typedef struct {
+    PyObject_HEAD
+    PyObject *owner;
+    Py_buffer export;
+    struct policy_table *policy;
+    int maxtype;
+    int view;
+    struct nlattr **attrs;
+    PyObject **cache;
+} AttributeTable;
+
+extern PyTypeObject AttributeTableType;
+
+/**
+ * Creates a new empty attribute table, the caller fills the attrs index.
+ *
+ * @param owner The object that owns the attributes memory, exporting it through the buffer protocol.
+ * @param policy The policies the attributes are parsed with, its maxtype is the table's.
+ * @param view Whether the attributes created by the table are views or copies.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+AttributeTable *attribute_table_new(PyObject *owner, struct policy_table *policy, int view);
+
+#endif
@@ -0,0 +1,222 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "dump.h"
+#include "message.h"
+
+/**
+ * Creates an iterator over the answer of a dump request that was already sent.
+ *
+ * @param netlink The netlink the request was sent on.
+ * @param seq Sequence number of the request.
+ * @param timeout Seconds to wait for every datagram, negative to wait forever and zero to not wait at all.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+DumpIterator *dump_iterator_new(NetLink *netlink, unsigned int seq, double timeout) {
+	DumpIterator *iterator = PyObject_New(DumpIterator, &DumpIteratorType);
+
+	if (iterator == NULL) {
+		return NULL;
+	}
+
+	Py_INCREF(netlink);
+	iterator->netlink = netlink;
+	iterator->seq = seq;
+	iterator->timeout = timeout;
+	iterator->buf = NULL;
+	iterator->next = NULL;
+	iterator->len = 0;
+	iterator->done = 0;
+	iterator->interrupted = 0;
+	iterator->count = 0;
+
+	return iterator;
+}
+
+/**
+ * Reads the next datagram of the dump.
+ *
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int dump_read(DumpIterator *self) {
+	NetLink *netlink = self->netlink;
+	int len = 0;
+
+	while (len == 0) {
+		if (netlink_ensure_open(netlink) < 0) {
+			return -1;
+		}
+
+		int ready = netlink_wait_readable(netlink, self->timeout);
+
+		if (ready < 0) {
+			return -1;
+		}
+
+		if (ready == 0) {
+			PyErr_SetString(PyExc_TimeoutError, "Timed out waiting for the dump.");
+			return -1;
+		}
+
+		netlink->io_count++;
+		Py_BEGIN_ALLOW_THREADS
+		len = recv_raw_nl(netlink->netlink, &self->buf);
+		Py_END_ALLOW_THREADS
+		netlink->io_count--;
+
+		if (len == 0 && self->timeout == 0) {
+			// not waiting at all, the socket is never polled.
+			PyErr_SetString(PyExc_TimeoutError, "Nothing of the dump is queued.");
+			return -1;
+		}
+
+		if (len <= 0) {
+			free(self->buf);
+			self->buf = NULL;
+		}
+	}
+
+	if (len == -NLE_RECV_NOMEM) {
+		// nothing was read, the iteration can go on.
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	if (len < 0) {
+		// an overrun loses part of the dump, it has to be restarted.
+		self->done = 1;
+
+		if (len == -NLE_NOMEM && netlink_overrun(netlink) < 0) {
+			return -1;
+		}
+
+		PyErr_Format(PyExc_OSError, "Failed to receive the dump: %s", nl_geterror(len));
+		return -1;
+	}
+
+	self->next = (struct nlmsghdr *) self->buf;
+	self->len = len;
+
+	return 0;
+}
+
+static PyObject *DumpIterator_next(DumpIterator *self) {
+	while (1) {
+		while (self->buf != NULL && nlmsg_ok(self->next, self->len)) {
+			struct nlmsghdr *hdr = self->next;
+			self->next = nlmsg_next(hdr, &self->len);
+
+			if (hdr->nlmsg_seq != self->seq) {
+				// not part of the dump, route it as any other received message.
+				if (netlink_dispatch_message(hdr, self->netlink) < 0) {
+					return NULL;
+				}
+
+				continue;
+			}
+
+			if (hdr->nlmsg_flags & NLM_F_DUMP_INTR) {
+				self->interrupted = 1;
+			}
+
+			if (hdr->nlmsg_type == NLMSG_DONE) {
+				self->done = 1;
+				break;
+			}
+
+			if (hdr->nlmsg_type == NLMSG_ERROR) {
+				struct nlmsgerr *err = nlmsg_data(hdr);
+
+				self->done = 1;
+				errno = hdr->nlmsg_len < (__u32) nlmsg_size(sizeof(*err)) ? EBADMSG : -err->error;
+				PyErr_SetFromErrno(PyExc_OSError);
+				return NULL;
+			}
+
+			if (hdr->nlmsg_type == NLMSG_NOOP || hdr->nlmsg_type == NLMSG_OVERRUN) {
+				continue;
+			}
+
+			Message *message = message_from_hdr(hdr, self->netlink->message_type);
+
+			if (message == NULL) {
+				return NULL;
+			}
+
+			self->count++;
+			return (PyObject *) message;
+		}
+
+		free(self->buf);
+		self->buf = NULL;
+
+		if (self->done) {
+			return NULL; // StopIteration
+		}
+
+		if (dump_read(self) < 0) {
+			return NULL;
+		}
+	}
+}
+
+static void DumpIterator_dealloc(DumpIterator *self) {
+	free(self->buf);
+	Py_XDECREF(self->netlink);
+
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMemberDef DumpIterator_members[] = {
+    {"seq", T_UINT, offsetof(DumpIterator, seq), READONLY, "Sequence number of the dump request."},
+    {"done", T_BOOL, offsetof(DumpIterator, done), READONLY, "Whether the dump ended."},
+    {"interrupted", T_BOOL, offsetof(DumpIterator, interrupted), READONLY, "Whether the kernel flagged the dump with NLM_F_DUMP_INTR (the dump may be inconsistent and should be restarted)."},
+    {"count", T_LONG, offsetof(DumpIterator, count), READONLY, "Number of messages yielded so far."},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject DumpIteratorType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.DumpIterator", /* tp_name */
+    sizeof(DumpIterator),                             /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)DumpIterator_dealloc,                 /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                               /* tp_flags */
+    "Iterator over the messages of a dump, yields them as they arrive.", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    PyObject_SelfIter,      /* tp_iter */
+    (iternextfunc)DumpIterator_next, /* tp_iternext */
+    0,                      /* tp_methods */
+    DumpIterator_members,   /* tp_members */
+};
@@ -0,0 +1,65 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DUMP_H
+#define DUMP_H
+
+#include "Python.h"
+#include <structmember.h>
+#include "netlink_class.h"
+
+/**
+ * Iterator over the multipart answer of a dump request.
+ * Holds at most one datagram at a time, so the memory stays bounded no matter the size of the dump.
+ *
+ * netlink -> The netlink the dump was requested on.
+ * seq -> Sequence number of the dump request.
+ * timeout -> Seconds to wait for every datagram, negative to wait forever.
+ * buf -> The datagram being walked, NULL if it was exhausted.
+ * next -> The next message in buf.
+ * len -> Bytes left in buf from next.
+ * done -> Whether NLMSG_DONE (or an error) arrived.
+ * interrupted -> Whether a message was flagged with NLM_F_DUMP_INTR (the dump may be inconsistent).
+ * count -> Number of messages yielded so far.
+ */
+typedef struct {
+    PyObject_HEAD
+    NetLink *netlink;
+    unsigned int seq;
+    double timeout;
+    unsigned char *buf;
+    struct nlmsghdr *next;
+    int len;
+    int done;
+    int interrupted;
+    long count;
+} DumpIterator;
+
+extern PyTypeObject DumpIteratorType;
+
+/**
+ * Creates an iterator over the answer of a dump request that was already sent.
+ *
+ * @param netlink The netlink the request was sent on.
+ * @param seq Sequence number of the request.
+ * @param timeout Seconds to wait for every datagram, negative to wait forever and zero to not wait at all.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+DumpIterator *dump_iterator_new(NetLink *netlink, unsigned int seq, double timeout);
+
+#endif
@@ -58,6 +58,19 @@ PyTypeObject CBKindType = {
     .tp_new = PyType_GenericNew,
 };
 
+typedef struct {
+	PyObject_HEAD
+} CB_ACTION;
+
+PyTypeObject CBActionType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "netlink.CB_ACTION",
+    .tp_basicsize = sizeof(CB_ACTION),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+};
+
 /**
  * Initializes the enums, should be callled on the initializatino of the module.  *
  */
@@ -78,6 +91,11 @@ void initialize_enums() {
 	PyDict_SetItemString(CBKindType.tp_dict, "CB_VERBOSE", PyLong_FromLong(NL_CB_VERBOSE));
 	PyDict_SetItemString(CBKindType.tp_dict, "CB_DEBUG", PyLong_FromLong(NL_CB_DEBUG));
 	PyDict_SetItemString(CBKindType.tp_dict, "CB_CUSTOM", PyLong_FromLong(NL_CB_CUSTOM));
+	PyDict_SetItemString(CBKindType.tp_dict, "CB_BATCH", PyLong_FromLong(CB_KIND_BATCH));
+
+	PyDict_SetItemString(CBActionType.tp_dict, "CB_OK", PyLong_FromLong(NL_OK));
+	PyDict_SetItemString(CBActionType.tp_dict, "CB_SKIP", PyLong_FromLong(NL_SKIP));
+	PyDict_SetItemString(CBActionType.tp_dict, "CB_STOP", PyLong_FromLong(NL_STOP));
 
 	PyDict_SetItemString(AttributeType.tp_dict, "UNSPEC", PyLong_FromLong(NLA_UNSPEC));
 	PyDict_SetItemString(AttributeType.tp_dict, "U8", PyLong_FromLong(NLA_U8));
@@ -88,6 +106,12 @@ void initialize_enums() {
 	PyDict_SetItemString(AttributeType.tp_dict, "FLAG", PyLong_FromLong(NLA_FLAG));
 	PyDict_SetItemString(AttributeType.tp_dict, "MSECS", PyLong_FromLong(NLA_MSECS));
 	PyDict_SetItemString(AttributeType.tp_dict, "NESTED", PyLong_FromLong(NLA_NESTED));
+	PyDict_SetItemString(AttributeType.tp_dict, "NUL_STRING", PyLong_FromLong(NLA_NUL_STRING));
+	PyDict_SetItemString(AttributeType.tp_dict, "BINARY", PyLong_FromLong(NLA_BINARY));
+	PyDict_SetItemString(AttributeType.tp_dict, "S8", PyLong_FromLong(NLA_S8));
+	PyDict_SetItemString(AttributeType.tp_dict, "S16", PyLong_FromLong(NLA_S16));
+	PyDict_SetItemString(AttributeType.tp_dict, "S32", PyLong_FromLong(NLA_S32));
+	PyDict_SetItemString(AttributeType.tp_dict, "S64", PyLong_FromLong(NLA_S64));
 }
 
 #endif
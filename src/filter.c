@@ -0,0 +1,187 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "filter.h"
+#include <arpa/inet.h>
+#include <stddef.h>
+
+#define FILTER_ACCEPT 0xffffffff
+#define FILTER_DROP 0
+
+// NLA_TYPE_MASK is a negative int.
+#define ATTR_TYPE_MASK ((uint16_t) NLA_TYPE_MASK)
+
+// offsets of the low and high bytes of nlmsg_type.
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define TYPE_LOW_BYTE offsetof(struct nlmsghdr, nlmsg_type)
+#define TYPE_HIGH_BYTE (offsetof(struct nlmsghdr, nlmsg_type) + 1)
+#else
+#define TYPE_LOW_BYTE (offsetof(struct nlmsghdr, nlmsg_type) + 1)
+#define TYPE_HIGH_BYTE offsetof(struct nlmsghdr, nlmsg_type)
+#endif
+
+/**
+ * Number of instructions of a rule.
+ */
+static int rule_length(const struct filter_rule *rule) {
+    // length check, conditions and the accept.
+    return 2 + 2 * (rule->type >= 0) + 2 * (rule->cmd >= 0) + 3 * (rule->attr >= 0) + 2 * (rule->attr >= 0 && rule->has_value) + 1;
+}
+
+/**
+ * Number of bytes a message must have for a rule to be checked.
+ */
+static int rule_min_length(const struct filter_rule *rule, int attrs) {
+    int length = NLMSG_HDRLEN;
+
+    if (rule->cmd >= 0) {
+        length = NLMSG_HDRLEN + 1;
+    }
+
+    if (rule->attr >= 0) {
+        length = attrs + rule->offset + NLA_HDRLEN + (rule->has_value ? rule->size : 0);
+    }
+
+    return length;
+}
+
+/**
+ * Checks a rule's fields.
+ *
+ * @return zero if valid, -EINVAL otherwise.
+ */
+static int rule_check(const struct filter_rule *rule) {
+    if (rule->type > UINT16_MAX || rule->cmd > UINT8_MAX || rule->attr > ATTR_TYPE_MASK) {
+        return -EINVAL;
+    }
+
+    if (rule->attr < 0 && rule->has_value) {
+        return -EINVAL;
+    }
+
+    if (rule->attr >= 0 && (rule->offset < 0 || rule->offset % NLA_ALIGNTO != 0 || rule->offset > UINT16_MAX)) {
+        return -EINVAL;
+    }
+
+    if (rule->has_value && rule->size != 1 && rule->size != 2 && rule->size != 4) {
+        return -EINVAL;
+    }
+
+    if (rule->has_value && rule->size < 4 && rule->value >> (rule->size * 8) != 0) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * Compiles rules into a BPF program.
+ *
+ * @param rules The rules.
+ * @param count Number of rules, at most FILTER_MAX_RULES.
+ * @param attrs Offset of the attributes in a message (the netlink header and the family's header).
+ * @param program Set to the program, the caller must free it.
+ * @return Number of instructions, -EINVAL if a rule is invalid or -ENOMEM upon failure.
+ */
+int filter_compile(const struct filter_rule *rules, int count, int attrs, struct sock_filter **program) {
+    // the control messages check and the final drop.
+    int length = 5 + 1;
+
+    if (count <= 0 || count > FILTER_MAX_RULES) {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (rule_check(&rules[i]) < 0) {
+            return -EINVAL;
+        }
+
+        length += rule_length(&rules[i]);
+    }
+
+    struct sock_filter *code = calloc(length, sizeof(struct sock_filter));
+    int pc = 0;
+
+    if (code == NULL) {
+        return -ENOMEM;
+    }
+
+    // control messages (nlmsg_type below NLMSG_MIN_TYPE) are always accepted, a BPF load compares in network order.
+    code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_B | BPF_ABS, TYPE_HIGH_BYTE);
+    code[pc++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 0, 3);
+    code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_B | BPF_ABS, TYPE_LOW_BYTE);
+    code[pc++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, NLMSG_MIN_TYPE, 1, 0);
+    code[pc++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, FILTER_ACCEPT);
+
+    for (int i = 0; i < count; i++) {
+        const struct filter_rule *rule = &rules[i];
+        int next = pc + rule_length(rule);
+        int attr = attrs + rule->offset;
+
+        // a load past the end would abort the whole program, the length is checked first.
+        code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_W | BPF_LEN, 0);
+        code[pc] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, rule_min_length(rule, attrs), 0, next - pc - 1);
+        pc++;
+
+        if (rule->type >= 0) {
+            code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_H | BPF_ABS, offsetof(struct nlmsghdr, nlmsg_type));
+            code[pc] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(rule->type), 0, next - pc - 1);
+            pc++;
+        }
+
+        if (rule->cmd >= 0) {
+            // genlmsghdr.cmd is the first byte of the payload.
+            code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_B | BPF_ABS, NLMSG_HDRLEN);
+            code[pc] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, rule->cmd, 0, next - pc - 1);
+            pc++;
+        }
+
+        if (rule->attr >= 0) {
+            code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_H | BPF_ABS, attr + offsetof(struct nlattr, nla_type));
+            code[pc++] = (struct sock_filter) BPF_STMT(BPF_ALU | BPF_AND | BPF_K, htons(ATTR_TYPE_MASK));
+            code[pc] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(rule->attr), 0, next - pc - 1);
+            pc++;
+        }
+
+        if (rule->attr >= 0 && rule->has_value) {
+            uint32_t value = rule->value;
+            uint16_t size = BPF_W;
+
+            if (rule->size == 1) {
+                size = BPF_B;
+            } else if (rule->size == 2) {
+                size = BPF_H;
+                value = htons(value);
+            } else {
+                value = htonl(value);
+            }
+
+            code[pc++] = (struct sock_filter) BPF_STMT(BPF_LD | size | BPF_ABS, attr + NLA_HDRLEN);
+            code[pc] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, 0, next - pc - 1);
+            pc++;
+        }
+
+        code[pc++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, FILTER_ACCEPT);
+    }
+
+    code[pc++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, FILTER_DROP);
+
+    *program = code;
+
+    return pc;
+}
@@ -0,0 +1,71 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Compiles declarative message filters into classic BPF programs, attached to the socket with SO_ATTACH_FILTER
+ * so that unwanted messages are dropped in the kernel.
+ *
+ * The program accepts a datagram when its first message is a control message (so acks and errors always
+ * arrive) or matches any of the rules. A rule matches when all of its conditions hold.
+ * Multicast events carry one message per datagram, dump replies are accepted or dropped as a whole.
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <linux/filter.h>
+#include <linux/netlink.h>
+
+#define FILTER_MAX_RULES 256
+
+/**
+ * A rule, a negative field is a condition that isn't checked.
+ *
+ * type -> The nlmsg_type.
+ * cmd -> The generic netlink command.
+ * attr -> The type of the attribute at offset.
+ * offset -> Offset of the attribute from the start of the attributes.
+ * size -> Size of the attribute's value (1, 2 or 4).
+ * value -> The attribute's value, only checked when has_value is set.
+ * has_value -> Whether the attribute's value is checked.
+ */
+struct filter_rule {
+    int type;
+    int cmd;
+    int attr;
+    int offset;
+    int size;
+    uint32_t value;
+    int has_value;
+};
+
+/**
+ * Compiles rules into a BPF program.
+ *
+ * @param rules The rules.
+ * @param count Number of rules, at most FILTER_MAX_RULES.
+ * @param attrs Offset of the attributes in a message (the netlink header and the family's header).
+ * @param program Set to the program, the caller must free it.
+ * @return Number of instructions, -EINVAL if a rule is invalid or -ENOMEM upon failure.
+ */
+int filter_compile(const struct filter_rule *rules, int count, int attrs, struct sock_filter **program);
+
+#endif
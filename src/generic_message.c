@@ -0,0 +1,200 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "generic_message.h"
+
+/**
+ * Returns the generic netlink header of a message.
+ *
+ * @param message The message.
+ * @return The header, NULL if the message is too short or is a control message (error, done...).
+ */
+struct genlmsghdr *generic_message_header(Message *message) {
+	struct nlmsghdr *nlh = message_hdr(message);
+
+	if (nlh == NULL) {
+		return NULL;
+	}
+
+	if (nlh->nlmsg_type < NLMSG_MIN_TYPE || !genlmsg_valid_hdr(nlh, 0)) {
+		return NULL;
+	}
+
+	return genlmsg_hdr(nlh);
+}
+
+static PyObject *GenericMessage_get_cmd(GenericMessage *self, void *closure) {
+	struct genlmsghdr *genl = generic_message_header(&self->message);
+
+	if (genl == NULL) {
+		Py_RETURN_NONE;
+	}
+
+	return PyLong_FromLong(genl->cmd);
+}
+
+static PyObject *GenericMessage_get_version(GenericMessage *self, void *closure) {
+	struct genlmsghdr *genl = generic_message_header(&self->message);
+
+	if (genl == NULL) {
+		Py_RETURN_NONE;
+	}
+
+	return PyLong_FromLong(genl->version);
+}
+
+#define from_message_docs "A static method that views an existing message as a generic message, the buffer is shared (not copied).\n@param message The message (Message)\n@return A GenericMessage"
+
+static PyObject *generic_message_from_message(PyObject *cls, PyObject *args) {
+	Message *message;
+
+	if (!PyArg_ParseTuple(args, "O!", &MessageType, &message)) {
+		return NULL;
+	}
+
+	if (PyObject_TypeCheck(message, &GenericMessageType)) {
+		Py_INCREF(message);
+		return (PyObject *) message;
+	}
+
+	struct nlmsghdr *nlh = message_hdr(message);
+
+	if (nlh == NULL || !genlmsg_valid_hdr(nlh, 0)) {
+		PyErr_SetString(PyExc_ValueError, "The message is too short for a generic netlink header");
+		return NULL;
+	}
+
+	if (message->msg == NULL) {
+		// a wrapped message, the generic one wraps the same buffer.
+		return (PyObject *) message_wrap(&GenericMessageType, message->wrapped.obj, nlh);
+	}
+
+	Message *generic = message_alloc(&GenericMessageType);
+
+	if (generic == NULL) {
+		return NULL;
+	}
+
+	// borrow from the message that owns the buffer, so views don't chain.
+	generic->owner = message->owner != NULL ? message->owner : (PyObject *) message;
+	Py_INCREF(generic->owner);
+
+	// the export keeps the owner from replacing msg (reset, __init__) while it's shared.
+	if (PyObject_GetBuffer(generic->owner, &generic->wrapped, PyBUF_SIMPLE) < 0) {
+		generic->wrapped.obj = NULL;
+		Py_DECREF(generic);
+		return NULL;
+	}
+
+	generic->msg = message->msg;
+
+	return (PyObject *) generic;
+}
+
+/**
+ * @param family_id The family id.
+ * @param flags flags.
+ * @param cmd The command.
+ * @param version The family version.
+ * @param hdrlen Length of the family's own header, after the generic netlink header (default 0).
+ */
+static int GenericMessage_init(GenericMessage *self, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family_id", "flags", "cmd", "version", "hdrlen", NULL};
+	int family_id;
+	int flags;
+	int cmd;
+	int version;
+	int hdrlen = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "iiii|i", kwlist, &family_id, &flags, &cmd, &version, &hdrlen)) {
+		return -1;
+	}
+
+	if (message_check_exports(&self->message) < 0) {
+		return -1;
+	}
+
+	// __init__ called again.
+	message_release_buffer(&self->message);
+
+	self->message.msg = message_pool_acquire(getpagesize());
+
+	if (self->message.msg == NULL) {
+		PyErr_SetString(PyExc_MemoryError, "Can't allocate memory");
+		return -1;
+	}
+
+	if (!genlmsg_put(self->message.msg, NL_AUTO_PORT, NL_AUTO_SEQ, family_id, hdrlen, flags, cmd, version)) {
+		message_release_buffer(&self->message);
+		PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+		return -1;
+	}
+
+	return 0;
+}
+
+static PyGetSetDef GenericMessage_getset[] = {
+    {"cmd", (getter) GenericMessage_get_cmd, NULL, "The command, None for control messages (error, done...).", NULL},
+    {"version", (getter) GenericMessage_get_version, NULL, "The family version, None for control messages (error, done...).", NULL},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef GenericMessage_methods[] = {
+    {"from_message", (PyCFunction) generic_message_from_message, METH_VARARGS | METH_CLASS, from_message_docs},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject GenericMessageType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.GenericMessage", /* tp_name */
+    sizeof(GenericMessage),                           /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    0,                                                /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,         /* tp_flags */
+    "A generic netlink message, cmd and version are read from the buffer.", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    0,                      /* tp_iter */
+    0,                      /* tp_iternext */
+    GenericMessage_methods, /* tp_methods */
+    0,                      /* tp_members */
+    GenericMessage_getset,  /* tp_getset */
+    &MessageType,           /* tp_base */
+    0,                      /* tp_dict */
+    0,                      /* tp_descr_get */
+    0,                      /* tp_descr_set */
+    0,                      /* tp_dictoffset */
+    (initproc)GenericMessage_init, /* tp_init */
+    0,                      /* tp_alloc */
+    0,                      /* tp_new */
+};
@@ -0,0 +1,44 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENERIC_MESSAGE_H
+#define GENERIC_MESSAGE_H
+
+#include "Python.h"
+#include <structmember.h>
+#include "message.h"
+
+/**
+ * Represents a generic netlink message (a Message that starts with the generic netlink header).
+ * cmd and version are read from the buffer, nothing is copied.
+ */
+typedef struct {
+    Message message;
+} GenericMessage;
+
+extern PyTypeObject GenericMessageType;
+
+/**
+ * Returns the generic netlink header of a message.
+ *
+ * @param message The message.
+ * @return The header, NULL if the message is too short or is a control message (error, done...).
+ */
+struct genlmsghdr *generic_message_header(Message *message);
+
+#endif
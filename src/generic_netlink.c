@@ -0,0 +1,238 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "generic_netlink.h"
+#include "attribute_table.h"
+
+/**
+ * Checks that __init__ succeeded, the family and its policies are only known from then on.
+ *
+ * @param self The generic netlink.
+ * @return zero if initialised, -1 with an exception set otherwise.
+ */
+static int generic_netlink_check(GenericNetLink *self) {
+	if (self->netlink.netlink == NULL || self->netlink.policy_table == NULL) {
+		PyErr_SetString(PyExc_ValueError, "The generic netlink isn't initialised.");
+		return -1;
+	}
+
+	return 0;
+}
+
+#define message_docs "Creates a request for the family.\n@param cmd The command\n@param flags flags (default NLM_F_REQUEST)\n@return GenericMessage"
+
+static PyObject *generic_netlink_message(GenericNetLink *self, PyObject *args) {
+	int cmd;
+	int flags = NLM_F_REQUEST;
+
+	if (!PyArg_ParseTuple(args, "i|i", &cmd, &flags) || generic_netlink_check(self) < 0) {
+		return NULL;
+	}
+
+	Message *message = message_alloc(&GenericMessageType);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	message->msg = message_pool_acquire(getpagesize());
+
+	if (message->msg == NULL) {
+		Py_DECREF(message);
+		PyErr_SetString(PyExc_MemoryError, "Can't allocate memory");
+		return NULL;
+	}
+
+	if (!genlmsg_put(message->msg, NL_AUTO_PORT, NL_AUTO_SEQ, self->netlink.netlink->family_id,
+	                 self->hdrlen, flags, cmd, self->version)) {
+		Py_DECREF(message);
+		PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+		return NULL;
+	}
+
+	return (PyObject *) message;
+}
+
+#define generic_parse_docs "Parses a generic netlink message with genlmsg_parse.\nThe attributes are indexed in place, nothing is copied until accessed.\n@param message The message (Message or GenericMessage)\n@param view if true the attributes are views into the message's buffer instead of copies\n@return tuple of (AttributeTable, cmd, version)\n@raise ValueError if the message isn't a generic netlink message of the family's header size"
+
+static PyObject *generic_netlink_parse(GenericNetLink *self, PyObject *args) {
+	Message *message;
+	int view = 0;
+
+	if (!PyArg_ParseTuple(args, "O!|p", &MessageType, &message, &view) || generic_netlink_check(self) < 0) {
+		return NULL;
+	}
+
+	struct genlmsghdr *genl = generic_message_header(message);
+
+	if (genl == NULL || !genlmsg_valid_hdr(message_hdr(message), self->hdrlen)) {
+		PyErr_SetString(PyExc_ValueError, "Not a generic netlink message of this family");
+		return NULL;
+	}
+
+	struct policy_table *policy = self->netlink.policy_table;
+	AttributeTable *table = attribute_table_new((PyObject *) message, policy, view);
+
+	if (table == NULL) {
+		return NULL;
+	}
+
+	int err = genlmsg_parse(message_hdr(message), self->hdrlen, table->attrs, policy->maxtype, policy->policies);
+
+	if (err < 0) {
+		Py_DECREF(table);
+		PyErr_Format(PyExc_ValueError, "Failed to parse the attributes: %s", nl_geterror(err));
+		return NULL;
+	}
+
+	return Py_BuildValue("(Nii)", table, genl->cmd, genl->version);
+}
+
+/**
+ * @param family The family name (resolved through the families cache) or id.
+ * @param policies The attribute policies.
+ * @param hdrlen Length of the family's own header, after the generic netlink header (default 0).
+ * @param version The family version, by default the one the kernel reports (1 when the family is given by id).
+ */
+static int GenericNetLink_init(GenericNetLink *self, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family", "policies", "hdrlen", "version", NULL};
+	PyObject *family;
+	PyObject *policies;
+	int hdrlen = 0;
+	int version = -1;
+	int family_id;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|ii", kwlist, &family, &policies, &hdrlen, &version)) {
+		return -1;
+	}
+
+	if (hdrlen < 0) {
+		PyErr_SetString(PyExc_ValueError, "hdrlen must not be negative");
+		return -1;
+	}
+
+	if (PyUnicode_Check(family)) {
+		struct genl_cache_family cached;
+		const char *family_name = PyUnicode_AsUTF8(family);
+		int ret;
+
+		if (family_name == NULL) {
+			return -1;
+		}
+
+		Py_BEGIN_ALLOW_THREADS
+		ret = genl_cache_family(family_name, &cached);
+		Py_END_ALLOW_THREADS
+
+		if (ret == -NLE_OBJ_NOTFOUND) {
+			PyErr_Format(PyExc_LookupError, "No generic netlink family named %s", family_name);
+			return -1;
+		} else if (ret < 0) {
+			PyErr_Format(PyExc_OSError, "Failed to resolve the family: %s", nl_geterror(ret));
+			return -1;
+		}
+
+		family_id = cached.id;
+
+		if (version < 0) {
+			version = cached.version;
+		}
+
+		genl_cache_family_clear(&cached);
+	} else {
+		family_id = PyLong_AsLong(family);
+
+		if (family_id == -1 && PyErr_Occurred()) {
+			PyErr_SetString(PyExc_TypeError, "family must be a family name or id");
+			return -1;
+		}
+
+		if (version < 0) {
+			version = 1;
+		}
+	}
+
+	self->version = version;
+	self->hdrlen = hdrlen;
+
+	// the received messages are GenericMessages.
+	self->netlink.message_type = &GenericMessageType;
+
+	PyObject *base_args = Py_BuildValue("(iiiO)", family_id, NETLINK_GENERIC, GENL_HDRLEN + hdrlen, policies);
+
+	if (base_args == NULL) {
+		return -1;
+	}
+
+	int ret = NetLinkType.tp_init((PyObject *) self, base_args, NULL);
+	Py_DECREF(base_args);
+
+	return ret;
+}
+
+static PyMemberDef GenericNetLink_members[] = {
+    {"version", T_INT, offsetof(GenericNetLink, version), READONLY, "The family version."},
+    {"hdrlen", T_INT, offsetof(GenericNetLink, hdrlen), READONLY, "Length of the family's own header."},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef GenericNetLink_methods[] = {
+    {"message", (PyCFunction) generic_netlink_message, METH_VARARGS, message_docs},
+    {"parse_message", (PyCFunction) generic_netlink_parse, METH_VARARGS, generic_parse_docs},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject GenericNetLinkType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.GenericNetLink", /* tp_name */
+    sizeof(GenericNetLink),                           /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    0,                                                /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,         /* tp_flags */
+    "A NetLink bound to a generic netlink family.",   /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                       /* tp_richcompare */
+    0,                       /* tp_weaklistoffset */
+    0,                       /* tp_iter */
+    0,                       /* tp_iternext */
+    GenericNetLink_methods,  /* tp_methods */
+    GenericNetLink_members,  /* tp_members */
+    0,                       /* tp_getset */
+    &NetLinkType,            /* tp_base */
+    0,                       /* tp_dict */
+    0,                       /* tp_descr_get */
+    0,                       /* tp_descr_set */
+    0,                       /* tp_dictoffset */
+    (initproc)GenericNetLink_init, /* tp_init */
+    0,                       /* tp_alloc */
+    0,                       /* tp_new */
+};
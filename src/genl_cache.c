@@ -0,0 +1,621 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "genl_cache.h"
+#include <errno.h>
+#include <time.h>
+
+// seconds to wait for the controller to answer a request.
+#define GENL_CACHE_REQUEST_TIMEOUT 2
+
+/**
+ * The cache's state, protected by lock.
+ *
+ * sock -> Subscribed to the controller's notify group, read only by the listener thread.
+ * started -> Whether the socket and the listener thread are up.
+ * warm -> Whether the families dump completed and no notification was lost since.
+ * overruns -> Number of times notifications were lost.
+ * request_seq -> Sequence number of the request in progress, zero if none.
+ * request_done -> Whether the request in progress was answered.
+ * request_error -> The answer of the request in progress, zero upon success or a negative errno.
+ * families -> The cached families.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct nl_sock *sock;
+    int started;
+    int warm;
+    unsigned long overruns;
+    unsigned int request_seq;
+    int request_done;
+    int request_error;
+    int families_len;
+    int families_cap;
+    struct genl_cache_family *families;
+} cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t atfork_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Frees the arrays of a family.
+ *
+ * @param family The family.
+ */
+void genl_cache_family_clear(struct genl_cache_family *family) {
+    free(family->ops);
+    free(family->groups);
+    family->ops = NULL;
+    family->groups = NULL;
+    family->ops_len = 0;
+    family->groups_len = 0;
+}
+
+/**
+ * Finds a cached family by name.
+ */
+static struct genl_cache_family *find_family(const char *name) {
+    for (int i = 0; i < cache.families_len; i++) {
+        if (strncmp(cache.families[i].name, name, GENL_NAMSIZ) == 0) {
+            return &cache.families[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Removes a cached family by name.
+ */
+static void remove_family(const char *name) {
+    struct genl_cache_family *family = find_family(name);
+
+    if (family == NULL) {
+        return;
+    }
+
+    genl_cache_family_clear(family);
+    *family = cache.families[--cache.families_len];
+}
+
+/**
+ * Drops every cached family.
+ */
+static void clear_families(void) {
+    for (int i = 0; i < cache.families_len; i++) {
+        genl_cache_family_clear(&cache.families[i]);
+    }
+
+    cache.families_len = 0;
+}
+
+/**
+ * Parses a family out of a controller message.
+ *
+ * @param hdr The message.
+ * @param family Filled with the family, release it with genl_cache_family_clear.
+ * @return zero upon success, negative error code upon failure.
+ */
+static int parse_family(struct nlmsghdr *hdr, struct genl_cache_family *family) {
+    struct nlattr *tb[CTRL_ATTR_MAX + 1];
+    struct nlattr *nla;
+    int rem;
+    int ret;
+
+    memset(family, 0, sizeof(*family));
+
+    if ((ret = nlmsg_parse(hdr, GENL_HDRLEN, tb, CTRL_ATTR_MAX, NULL)) < 0) {
+        return ret;
+    }
+
+    if (!tb[CTRL_ATTR_FAMILY_NAME] || !tb[CTRL_ATTR_FAMILY_ID]) {
+        return -NLE_MISSING_ATTR;
+    }
+
+    nla_strlcpy(family->name, tb[CTRL_ATTR_FAMILY_NAME], GENL_NAMSIZ);
+    family->id = nla_get_u16(tb[CTRL_ATTR_FAMILY_ID]);
+    family->version = tb[CTRL_ATTR_VERSION] ? nla_get_u32(tb[CTRL_ATTR_VERSION]) : 0;
+    family->hdrsize = tb[CTRL_ATTR_HDRSIZE] ? nla_get_u32(tb[CTRL_ATTR_HDRSIZE]) : 0;
+    family->maxattr = tb[CTRL_ATTR_MAXATTR] ? nla_get_u32(tb[CTRL_ATTR_MAXATTR]) : 0;
+
+    if (tb[CTRL_ATTR_OPS]) {
+        nla_for_each_nested(nla, tb[CTRL_ATTR_OPS], rem) {
+            family->ops_len++;
+        }
+
+        family->ops = calloc(family->ops_len, sizeof(unsigned int));
+        family->ops_len = 0;
+
+        nla_for_each_nested(nla, tb[CTRL_ATTR_OPS], rem) {
+            struct nlattr *op[CTRL_ATTR_OP_MAX + 1];
+
+            if (family->ops && nla_parse_nested(op, CTRL_ATTR_OP_MAX, nla, NULL) == 0 && op[CTRL_ATTR_OP_ID]) {
+                family->ops[family->ops_len++] = nla_get_u32(op[CTRL_ATTR_OP_ID]);
+            }
+        }
+    }
+
+    if (tb[CTRL_ATTR_MCAST_GROUPS]) {
+        nla_for_each_nested(nla, tb[CTRL_ATTR_MCAST_GROUPS], rem) {
+            family->groups_len++;
+        }
+
+        family->groups = calloc(family->groups_len, sizeof(struct genl_cache_group));
+        family->groups_len = 0;
+
+        nla_for_each_nested(nla, tb[CTRL_ATTR_MCAST_GROUPS], rem) {
+            struct nlattr *group[CTRL_ATTR_MCAST_GRP_MAX + 1];
+
+            if (family->groups && nla_parse_nested(group, CTRL_ATTR_MCAST_GRP_MAX, nla, NULL) == 0
+                    && group[CTRL_ATTR_MCAST_GRP_NAME] && group[CTRL_ATTR_MCAST_GRP_ID]) {
+                struct genl_cache_group *entry = &family->groups[family->groups_len++];
+
+                nla_strlcpy(entry->name, group[CTRL_ATTR_MCAST_GRP_NAME], GENL_NAMSIZ);
+                entry->id = nla_get_u32(group[CTRL_ATTR_MCAST_GRP_ID]);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Adds (or replaces) a family in the cache, the cache takes the family's arrays.
+ */
+static void store_family(struct genl_cache_family *family) {
+    struct genl_cache_family *existing = find_family(family->name);
+
+    if (existing != NULL) {
+        genl_cache_family_clear(existing);
+        *existing = *family;
+        return;
+    }
+
+    if (cache.families_len == cache.families_cap) {
+        int cap = cache.families_cap ? cache.families_cap * 2 : 64;
+        struct genl_cache_family *families = realloc(cache.families, cap * sizeof(struct genl_cache_family));
+
+        if (families == NULL) {
+            // the family will be requested again on lookup.
+            genl_cache_family_clear(family);
+            return;
+        }
+
+        cache.families = families;
+        cache.families_cap = cap;
+    }
+
+    cache.families[cache.families_len++] = *family;
+}
+
+/**
+ * Adds or removes the multicast groups of a notification to/from the cached family.
+ */
+static void update_groups(struct genl_cache_family *notification, int add) {
+    struct genl_cache_family *family = find_family(notification->name);
+
+    if (family == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < notification->groups_len; i++) {
+        struct genl_cache_group *group = &notification->groups[i];
+        int j;
+
+        for (j = 0; j < family->groups_len && strncmp(family->groups[j].name, group->name, GENL_NAMSIZ) != 0; j++);
+
+        if (!add) {
+            if (j < family->groups_len) {
+                family->groups[j] = family->groups[--family->groups_len];
+            }
+        } else if (j < family->groups_len) {
+            family->groups[j].id = group->id;
+        } else {
+            struct genl_cache_group *groups = realloc(family->groups, (family->groups_len + 1) * sizeof(struct genl_cache_group));
+
+            if (groups != NULL) {
+                family->groups = groups;
+                family->groups[family->groups_len++] = *group;
+            }
+        }
+    }
+}
+
+/**
+ * Applies a message of the controller socket to the cache, called with the lock held.
+ *
+ * @param hdr The message.
+ * @param arg unused.
+ * @return zero.
+ */
+static int handle_message(struct nlmsghdr *hdr, void *arg) {
+    if (cache.request_seq != 0 && hdr->nlmsg_seq == cache.request_seq) {
+        if (hdr->nlmsg_type == NLMSG_DONE) {
+            cache.request_done = 1;
+            cache.request_error = 0;
+        } else if (hdr->nlmsg_type == NLMSG_ERROR) {
+            struct nlmsgerr *err = nlmsg_data(hdr);
+
+            cache.request_done = 1;
+            cache.request_error = hdr->nlmsg_len < (__u32) nlmsg_size(sizeof(*err)) ? -EBADMSG : err->error;
+        }
+    }
+
+    if (hdr->nlmsg_type != GENL_ID_CTRL || hdr->nlmsg_len < (__u32) nlmsg_size(GENL_HDRLEN)) {
+        return 0;
+    }
+
+    struct genlmsghdr *genl = nlmsg_data(hdr);
+    struct genl_cache_family family;
+
+    if (parse_family(hdr, &family) < 0) {
+        genl_cache_family_clear(&family);
+        return 0;
+    }
+
+    switch (genl->cmd) {
+    case CTRL_CMD_NEWFAMILY:
+        store_family(&family);
+        return 0;
+    case CTRL_CMD_DELFAMILY:
+        remove_family(family.name);
+        break;
+    case CTRL_CMD_NEWMCAST_GRP:
+        update_groups(&family, 1);
+        break;
+    case CTRL_CMD_DELMCAST_GRP:
+        update_groups(&family, 0);
+        break;
+    }
+
+    genl_cache_family_clear(&family);
+
+    return 0;
+}
+
+/**
+ * The listener thread, reads the controller socket (blocking) and applies every message to the cache.
+ *
+ * @param arg The socket.
+ */
+static void *listen_controller(void *arg) {
+    struct nl_sock *sock = arg;
+
+    while (1) {
+        struct sockaddr_nl nla;
+        unsigned char *buf = NULL;
+        int len = nl_recv(sock, &nla, &buf, NULL);
+
+        pthread_mutex_lock(&cache.lock);
+
+        if (cache.sock != sock) {
+            // the cache was reset (fork), this socket isn't used anymore.
+            pthread_mutex_unlock(&cache.lock);
+            free(buf);
+            break;
+        }
+
+        if (len > 0) {
+            struct nlmsghdr *hdr = (struct nlmsghdr *) buf;
+
+            while (nlmsg_ok(hdr, len)) {
+                handle_message(hdr, NULL);
+                hdr = nlmsg_next(hdr, &len);
+            }
+        } else if (len == -NLE_NOMEM) {
+            // notifications were lost, the next lookup dumps the families again.
+            cache.warm = 0;
+            cache.overruns++;
+        } else if (len < 0 && len != -NLE_AGAIN) {
+            cache.sock = NULL;
+            cache.started = 0;
+            cache.warm = 0;
+            nl_socket_free(sock);
+            pthread_cond_broadcast(&cache.changed);
+            pthread_mutex_unlock(&cache.lock);
+            free(buf);
+            break;
+        }
+
+        pthread_cond_broadcast(&cache.changed);
+        pthread_mutex_unlock(&cache.lock);
+        free(buf);
+    }
+
+    return NULL;
+}
+
+/**
+ * Resets the cache in a forked child, the listener thread doesn't exist there.
+ */
+static void reset_after_fork(void) {
+    pthread_mutex_init(&cache.lock, NULL);
+    pthread_cond_init(&cache.changed, NULL);
+
+    if (cache.sock != NULL) {
+        nl_socket_free(cache.sock);
+    }
+
+    cache.sock = NULL;
+    cache.started = 0;
+    cache.warm = 0;
+    cache.request_seq = 0;
+}
+
+static void register_atfork(void) {
+    pthread_atfork(NULL, NULL, reset_after_fork);
+}
+
+/**
+ * Opens the controller socket and starts the listener thread, called with the lock held.
+ *
+ * @return zero upon success, negative error code upon failure.
+ */
+static int start_listener(void) {
+    pthread_t thread;
+    int ret;
+
+    if (cache.started) {
+        return 0;
+    }
+
+    pthread_once(&atfork_once, register_atfork);
+
+    struct nl_sock *sock = nl_socket_alloc();
+
+    if (sock == NULL) {
+        return -NLE_NOMEM;
+    }
+
+    // the controller's notify group always has the controller's id.
+    if ((ret = nl_connect(sock, NETLINK_GENERIC)) < 0 || (ret = nl_socket_add_membership(sock, GENL_ID_CTRL)) < 0) {
+        nl_socket_free(sock);
+        return ret;
+    }
+
+    cache.sock = sock;
+
+    if (pthread_create(&thread, NULL, listen_controller, sock) != 0) {
+        cache.sock = NULL;
+        nl_socket_free(sock);
+        return -NLE_FAILURE;
+    }
+
+    pthread_detach(thread);
+    cache.started = 1;
+
+    return 0;
+}
+
+/**
+ * Sends a CTRL_CMD_GETFAMILY request and waits for its answer, called with the lock held.
+ * The families of the answer are stored by the listener thread.
+ *
+ * @param flags Additional flags (NLM_F_DUMP).
+ * @param family_name Name of the requested family, NULL for all of them.
+ * @return zero upon success, negative error code upon failure.
+ */
+static int request_families(int flags, const char *family_name) {
+    struct genlmsghdr genl = {
+        .cmd = CTRL_CMD_GETFAMILY,
+        .version = 1,
+    };
+    struct timespec deadline;
+    int ret = 0;
+
+    while (cache.started && cache.request_seq != 0) {
+        pthread_cond_wait(&cache.changed, &cache.lock);
+    }
+
+    if (!cache.started) {
+        return -NLE_BAD_SOCK;
+    }
+
+    struct nl_msg *msg = nlmsg_alloc();
+
+    if (msg == NULL) {
+        return -NLE_NOMEM;
+    }
+
+    if (!nlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, GENL_ID_CTRL, 0, NLM_F_REQUEST | NLM_F_ACK | flags)
+            || nlmsg_append(msg, &genl, sizeof(genl), NLMSG_ALIGNTO) < 0
+            || (family_name && nla_put_string(msg, CTRL_ATTR_FAMILY_NAME, family_name) < 0)) {
+        nlmsg_free(msg);
+        return -NLE_NOMEM;
+    }
+
+    nl_complete_msg(cache.sock, msg);
+    cache.request_seq = nlmsg_hdr(msg)->nlmsg_seq;
+    cache.request_done = 0;
+
+    ret = nl_send(cache.sock, msg);
+    nlmsg_free(msg);
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += GENL_CACHE_REQUEST_TIMEOUT;
+
+    while (ret >= 0 && cache.started && !cache.request_done) {
+        if (pthread_cond_timedwait(&cache.changed, &cache.lock, &deadline) == ETIMEDOUT) {
+            ret = -NLE_AGAIN;
+        }
+    }
+
+    if (ret >= 0) {
+        ret = !cache.started ? -NLE_BAD_SOCK : (cache.request_error < 0 ? -nl_syserr2nlerr(-cache.request_error) : 0);
+    }
+
+    cache.request_seq = 0;
+    pthread_cond_broadcast(&cache.changed);
+
+    return ret;
+}
+
+/**
+ * Makes sure the cache holds every family, called with the lock held.
+ *
+ * @return zero upon success, negative error code upon failure.
+ */
+static int warm_up(void) {
+    int ret;
+
+    while (!cache.warm) {
+        if ((ret = start_listener()) < 0) {
+            return ret;
+        }
+
+        unsigned long overruns = cache.overruns;
+
+        clear_families();
+
+        if ((ret = request_families(NLM_F_DUMP, NULL)) < 0) {
+            return ret;
+        }
+
+        // if notifications were lost during the dump, dump again.
+        cache.warm = overruns == cache.overruns;
+    }
+
+    return 0;
+}
+
+/**
+ * Finds a family, requesting it by name if it isn't cached, called with the lock held.
+ *
+ * @param family_name The family name.
+ * @param family Set to the cached family.
+ * @return zero upon success, negative error code upon failure.
+ */
+static int lookup_family(const char *family_name, struct genl_cache_family **family) {
+    int ret;
+
+    if ((ret = warm_up()) < 0) {
+        return ret;
+    }
+
+    *family = find_family(family_name);
+
+    if (*family != NULL) {
+        return 0;
+    }
+
+    // requesting the family by name lets the kernel autoload its module.
+    if ((ret = request_families(0, family_name)) < 0) {
+        return ret;
+    }
+
+    *family = find_family(family_name);
+
+    return *family != NULL ? 0 : -NLE_OBJ_NOTFOUND;
+}
+
+/**
+ * Resolves a family id from the family name.
+ *
+ * @param family_name The family name.
+ * @return The family id, negative error code upon failure.
+ */
+int genl_cache_family_id(const char *family_name) {
+    struct genl_cache_family *family;
+
+    pthread_mutex_lock(&cache.lock);
+    int ret = lookup_family(family_name, &family);
+
+    if (ret == 0) {
+        ret = family->id;
+    }
+
+    pthread_mutex_unlock(&cache.lock);
+
+    return ret;
+}
+
+/**
+ * Resolves a multicast group id from the family name and the group name.
+ *
+ * @param family_name The family name.
+ * @param group_name The group name.
+ * @return The group id, negative error code upon failure.
+ */
+int genl_cache_group_id(const char *family_name, const char *group_name) {
+    struct genl_cache_family *family;
+
+    pthread_mutex_lock(&cache.lock);
+    int ret = lookup_family(family_name, &family);
+
+    if (ret == 0) {
+        ret = -NLE_OBJ_NOTFOUND;
+
+        for (int i = 0; i < family->groups_len; i++) {
+            if (strncmp(family->groups[i].name, group_name, GENL_NAMSIZ) == 0) {
+                ret = family->groups[i].id;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&cache.lock);
+
+    return ret;
+}
+
+/**
+ * Copies a family out of the cache.
+ *
+ * @param family_name The family name.
+ * @param family Filled with a copy of the family, release it with genl_cache_family_clear.
+ * @return zero upon success, negative error code upon failure.
+ */
+int genl_cache_family(const char *family_name, struct genl_cache_family *family) {
+    struct genl_cache_family *cached;
+
+    memset(family, 0, sizeof(*family));
+
+    pthread_mutex_lock(&cache.lock);
+    int ret = lookup_family(family_name, &cached);
+
+    if (ret == 0) {
+        *family = *cached;
+        family->ops = malloc((cached->ops_len + 1) * sizeof(unsigned int));
+        family->groups = malloc((cached->groups_len + 1) * sizeof(struct genl_cache_group));
+
+        if (family->ops == NULL || family->groups == NULL) {
+            genl_cache_family_clear(family);
+            ret = -NLE_NOMEM;
+        } else {
+            memcpy(family->ops, cached->ops, cached->ops_len * sizeof(unsigned int));
+            memcpy(family->groups, cached->groups, cached->groups_len * sizeof(struct genl_cache_group));
+        }
+    }
+
+    pthread_mutex_unlock(&cache.lock);
+
+    return ret;
+}
+
+/**
+ * Drops the cache, the next lookup dumps the families again.
+ */
+void genl_cache_invalidate(void) {
+    pthread_mutex_lock(&cache.lock);
+    cache.warm = 0;
+    clear_families();
+    pthread_mutex_unlock(&cache.lock);
+}
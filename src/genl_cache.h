@@ -0,0 +1,115 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Process wide cache of the generic netlink families (ids, ops and multicast groups).
+ *
+ * The cache is filled by one CTRL_CMD_GETFAMILY dump, then kept up to date by a background thread
+ * listening to the controller's notify group, so lookups after the warm up don't make any syscall.
+ * A family that isn't in the cache is requested by name once (that way the kernel can still autoload its module).
+ *
+ * None of the functions touch python objects, they may be called without holding the GIL.
+ */
+
+#ifndef GENL_CACHE_H
+#define GENL_CACHE_H
+
+#include <netlink/netlink.h>
+#include <netlink/msg.h>
+#include <netlink/attr.h>
+#include <netlink/socket.h>
+#include <linux/genetlink.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A multicast group of a family.
+ *
+ * name -> The group's name.
+ * id -> The group's id.
+ */
+struct genl_cache_group {
+    char name[GENL_NAMSIZ];
+    unsigned int id;
+};
+
+/**
+ * A cached family.
+ *
+ * name -> The family's name.
+ * id -> The family's id.
+ * version -> The family's version.
+ * hdrsize -> Size of the family's user header.
+ * maxattr -> The family's highest attribute type.
+ * ops_len -> Number of commands.
+ * ops -> The commands the family supports.
+ * groups_len -> Number of multicast groups.
+ * groups -> The family's multicast groups.
+ */
+struct genl_cache_family {
+    char name[GENL_NAMSIZ];
+    int id;
+    int version;
+    int hdrsize;
+    int maxattr;
+    int ops_len;
+    unsigned int *ops;
+    int groups_len;
+    struct genl_cache_group *groups;
+};
+
+/**
+ * Resolves a family id from the family name.
+ *
+ * @param family_name The family name.
+ * @return The family id, negative error code upon failure.
+ */
+int genl_cache_family_id(const char *family_name);
+
+/**
+ * Resolves a multicast group id from the family name and the group name.
+ *
+ * @param family_name The family name.
+ * @param group_name The group name.
+ * @return The group id, negative error code upon failure.
+ */
+int genl_cache_group_id(const char *family_name, const char *group_name);
+
+/**
+ * Copies a family out of the cache.
+ *
+ * @param family_name The family name.
+ * @param family Filled with a copy of the family, release it with genl_cache_family_clear.
+ * @return zero upon success, negative error code upon failure.
+ */
+int genl_cache_family(const char *family_name, struct genl_cache_family *family);
+
+/**
+ * Frees the arrays of a family.
+ *
+ * @param family The family.
+ */
+void genl_cache_family_clear(struct genl_cache_family *family);
+
+/**
+ * Drops the cache, the next lookup dumps the families again.
+ */
+void genl_cache_invalidate(void);
+
+#endif
@@ -22,6 +22,14 @@
 #include "message.h"
 #include "enums.h"
 #include "attribute.h"
+#include "attribute_table.h"
+#include "dump.h"
+#include "message_template.h"
+#include "generic_message.h"
+#include "generic_netlink.h"
+#include "stream.h"
+#include "ack.h"
+#include "netlink_pool.h"
 
 static struct PyModuleDef netlink = {
     PyModuleDef_HEAD_INIT, "netlink", /* name of module */
@@ -41,6 +49,10 @@ PyMODINIT_FUNC PyInit_netlink(void) {
   if (PyType_Ready(&CBKindType) < 0) {
 	      return NULL;
   }
+
+  if (PyType_Ready(&CBActionType) < 0) {
+	      return NULL;
+  }
   if (PyType_Ready(&NetLinkType) < 0) {
   	return NULL;
   }
@@ -57,6 +69,38 @@ PyMODINIT_FUNC PyInit_netlink(void) {
       return NULL;
   }
 
+  if (PyType_Ready(&AttributeTableType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&DumpIteratorType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&MessageTemplateType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&GenericMessageType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&GenericNetLinkType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&StreamIteratorType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&AckType) < 0) {
+      return NULL;
+  }
+
+  if (PyType_Ready(&NetLinkPoolType) < 0) {
+      return NULL;
+  }
+
   module = PyModule_Create(&netlink);
 
   if (!module) {
@@ -72,6 +116,30 @@ PyMODINIT_FUNC PyInit_netlink(void) {
   Py_INCREF(&AttributeType);
   PyModule_AddObject(module, "Attribute", (PyObject *) &AttributeType);
 
+  Py_INCREF(&AttributeTableType);
+  PyModule_AddObject(module, "AttributeTable", (PyObject *) &AttributeTableType);
+
+  Py_INCREF(&DumpIteratorType);
+  PyModule_AddObject(module, "DumpIterator", (PyObject *) &DumpIteratorType);
+
+  Py_INCREF(&MessageTemplateType);
+  PyModule_AddObject(module, "MessageTemplate", (PyObject *) &MessageTemplateType);
+
+  Py_INCREF(&GenericMessageType);
+  PyModule_AddObject(module, "GenericMessage", (PyObject *) &GenericMessageType);
+
+  Py_INCREF(&GenericNetLinkType);
+  PyModule_AddObject(module, "GenericNetLink", (PyObject *) &GenericNetLinkType);
+
+  Py_INCREF(&StreamIteratorType);
+  PyModule_AddObject(module, "StreamIterator", (PyObject *) &StreamIteratorType);
+
+  Py_INCREF(&AckType);
+  PyModule_AddObject(module, "Ack", (PyObject *) &AckType);
+
+  Py_INCREF(&NetLinkPoolType);
+  PyModule_AddObject(module, "NetLinkPool", (PyObject *) &NetLinkPoolType);
+
 
   Py_INCREF(&CBTypeType);
   PyModule_AddObject(module, "CB_Type", (PyObject *) &CBTypeType);
@@ -79,6 +147,9 @@ PyMODINIT_FUNC PyInit_netlink(void) {
   Py_INCREF(&CBKindType);
   PyModule_AddObject(module, "CB_Kind", (PyObject *) &CBKindType);
 
+  Py_INCREF(&CBActionType);
+  PyModule_AddObject(module, "CB_Action", (PyObject *) &CBActionType);
+
   Py_INCREF(&AttributePolicyType);
   PyModule_AddObject(module, "AttributePolicy", (PyObject *) &AttributePolicyType);
 
@@ -17,7 +17,236 @@
 */
   
 #include "message.h"
+#include "attribute.h"
+#include "attribute_policy.h"
+#include "stream.h"
+#include "ack.h"
+#include "rtnl_dump.h"
 
+/**
+ * The freed objects of a message type.
+ */
+struct message_freelist {
+	PyTypeObject *type;
+	int len;
+	Message *objects[MESSAGE_FREELIST_MAX];
+};
+
+static struct message_freelist freelists[MESSAGE_FREELIST_TYPES];
+static unsigned long object_hits;
+static unsigned long object_misses;
+
+/**
+ * Finds the free list of a type.
+ *
+ * @param type The type.
+ * @param claim Whether to give the type a free list if it has none yet.
+ * @return The free list, NULL if the type isn't pooled.
+ */
+static struct message_freelist *find_freelist(PyTypeObject *type, int claim) {
+	// python subclasses may be bigger and hold a dict, only the C types are reused.
+	if ((type->tp_flags & Py_TPFLAGS_HEAPTYPE) || type->tp_basicsize != sizeof(Message)) {
+		return NULL;
+	}
+
+	for (int i = 0; i < MESSAGE_FREELIST_TYPES; i++) {
+		if (freelists[i].type == type) {
+			return &freelists[i];
+		}
+
+		if (freelists[i].type == NULL && claim) {
+			freelists[i].type = type;
+			return &freelists[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Creates an empty Message (without a buffer), reusing a freed one when possible.
+ *
+ * @param type MessageType or one of its C subclasses.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_alloc(PyTypeObject *type) {
+	struct message_freelist *freelist = find_freelist(type, 0);
+	Message *message;
+
+	if (freelist != NULL && freelist->len > 0) {
+		message = freelist->objects[--freelist->len];
+
+		object_hits++;
+		PyObject_Init((PyObject *) message, type);
+	} else {
+		object_misses++;
+		// tp_alloc also takes care of python subclasses (gc, dict).
+		message = (Message *) type->tp_alloc(type, 0);
+
+		if (message == NULL) {
+			return NULL;
+		}
+	}
+
+	message->msg = NULL;
+	message->owner = NULL;
+	message->wrapped.obj = NULL;
+	message->exports = 0;
+
+	return message;
+}
+
+/**
+ * Creates a Message holding a copy of a raw message, the copy is taken from the buffer pool.
+ *
+ * @param hdr The raw message.
+ * @param type MessageType or one of its C subclasses.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_from_hdr(struct nlmsghdr *hdr, PyTypeObject *type) {
+	Message *message = message_alloc(type);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	message->msg = message_pool_convert(hdr);
+
+	if (message->msg == NULL) {
+		Py_DECREF(message);
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	return message;
+}
+
+/**
+ * Drops the message's buffer, giving it back to the pool if the message owns it.
+ *
+ * @param self The message.
+ */
+void message_release_buffer(Message *self) {
+	if (self->owner != NULL) {
+		Py_CLEAR(self->owner);
+	} else if (self->msg != NULL) {
+		message_pool_release(self->msg);
+	}
+
+	if (self->wrapped.obj != NULL) {
+		PyBuffer_Release(&self->wrapped);
+	}
+
+	self->msg = NULL;
+}
+
+/**
+ * Creates a Message that wraps a message inside a foreign buffer (no copy).
+ * The message is copied instead if it is misaligned.
+ *
+ * @param type MessageType or one of its C subclasses.
+ * @param object The object exporting the buffer, kept alive by the message.
+ * @param hdr The message, a full message inside the object's buffer.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_wrap(PyTypeObject *type, PyObject *object, struct nlmsghdr *hdr) {
+	Message *message = message_alloc(type);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	// the headers can't be read in place from a misaligned buffer (a slice for example).
+	if ((uintptr_t) hdr % NLMSG_ALIGNTO != 0) {
+		message->msg = message_pool_convert(hdr);
+
+		if (message->msg == NULL) {
+			Py_DECREF(message);
+			return (Message *) PyErr_NoMemory();
+		}
+
+		return message;
+	}
+
+	if (PyObject_GetBuffer(object, &message->wrapped, PyBUF_SIMPLE) < 0) {
+		message->wrapped.obj = NULL;
+		Py_DECREF(message);
+		return NULL;
+	}
+
+	// the view is narrowed to the message, releasing it only needs wrapped.obj.
+	message->wrapped.buf = hdr;
+	message->wrapped.len = hdr->nlmsg_len;
+
+	return message;
+}
+
+/**
+ * Invalidates a callback scoped view once its callback returned.
+ * The buffer is dropped, unless views of it are still exported (then it stays valid).
+ *
+ * @param self The message.
+ */
+void message_invalidate(Message *self) {
+	if (self->exports == 0) {
+		message_release_buffer(self);
+	}
+}
+
+/**
+ * Returns the raw message, in msg or in the wrapped buffer.
+ *
+ * @param self The message.
+ * @return The raw message, NULL if the message has no buffer.
+ */
+struct nlmsghdr *message_hdr(Message *self) {
+	if (self->msg != NULL) {
+		return nlmsg_hdr(self->msg);
+	}
+
+	return self->wrapped.obj != NULL ? (struct nlmsghdr *) self->wrapped.buf : NULL;
+}
+
+/**
+ * Returns the message's nl_msg for writing or sending,
+ * a message that wraps a foreign buffer is copied into a pooled buffer first.
+ *
+ * @param self The message.
+ * @return The nl_msg, NULL with an exception set upon failure.
+ */
+struct nl_msg *message_nl_msg(Message *self) {
+	if (self->msg != NULL) {
+		return self->msg;
+	}
+
+	if (self->wrapped.obj == NULL) {
+		PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+		return NULL;
+	}
+
+	self->msg = message_pool_convert((struct nlmsghdr *) self->wrapped.buf);
+
+	if (self->msg == NULL) {
+		PyErr_NoMemory();
+	}
+
+	return self->msg;
+}
+
+/**
+ * Fails if views of the message's buffer are exported, before the buffer is replaced.
+ *
+ * @param self The message.
+ * @return zero if not exported, -1 with an exception set otherwise.
+ */
+int message_check_exports(Message *self) {
+	if (self->exports > 0) {
+		PyErr_SetString(PyExc_BufferError, "The message's buffer is exported, release the views first");
+		return -1;
+	}
+
+	return 0;
+}
 
 #define reserve_docs "Reserves room for additional data at the tail of the an existing netlink message. Eventual padding required will be zeroed out.\n@param len length of additional data to reserve room for\n@param pad number of bytes to align data to\n@return null"
 
@@ -30,18 +259,28 @@ static PyObject * message_reserve(Message *self, PyObject *args) {
         return NULL;
     }
 
-    nlmsg_reserve(self->msg, len, pad);
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    nlmsg_reserve(msg, len, pad);
 
     Py_RETURN_NONE;
 }
 
-#define get_bytes_docs "@return message in bytes (headers + payload)"
+#define get_bytes_docs "@return message in bytes (headers + payload), a copy (memoryview(message) doesn't copy)"
 
 static PyObject * message_get_bytes(Message *self, PyObject *args) {
-	struct nlmsghdr *nlh = nlmsg_hdr(self->msg);
-	int message_len = NLMSG_LENGTH(nlh->nlmsg_len);
+	struct nlmsghdr *nlh = message_hdr(self);
 
-	PyObject * message_bytes = PyBytes_FromStringAndSize((char *) nlh, message_len);
+	if (nlh == NULL) {
+		PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+		return NULL;
+	}
+
+	PyObject * message_bytes = PyBytes_FromStringAndSize((char *) nlh, nlh->nlmsg_len);
 
 	return message_bytes;
 } 
@@ -56,7 +295,14 @@ static PyObject * message_append(Message *self, PyObject *args) {
         return NULL;
     }
 
-    if (nlmsg_append(self->msg, (char *) buffer.buf, buffer.len, pad) > 0) {
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL) {
+        PyBuffer_Release(&buffer);
+        return NULL;
+    }
+
+    if (nlmsg_append(msg, (char *) buffer.buf, buffer.len, pad) > 0) {
         return NULL;
     }
 
@@ -72,7 +318,13 @@ static PyObject * message_nla_nested_start(Message *self, PyObject *args)
 		return NULL;
 	}
 
-	struct nlattr *start = nla_nest_start(self->msg, argtype);
+	struct nl_msg *msg = message_nl_msg(self);
+
+	if (msg == NULL) {
+		return NULL;
+	}
+
+	struct nlattr *start = nla_nest_start(msg, argtype);
 
 	return PyLong_FromVoidPtr(start);
 }
@@ -88,7 +340,13 @@ static PyObject * message_nla_nested_end(Message *self, PyObject *args)
 
 	struct nlattr* start = (struct nlattr*) PyLong_AsVoidPtr(nlattr_start);
 
-	nla_nest_end(self->msg, start);
+	struct nl_msg *msg = message_nl_msg(self);
+
+	if (msg == NULL) {
+		return NULL;
+	}
+
+	nla_nest_end(msg, start);
 
 	Py_RETURN_NONE;
 }
@@ -103,39 +361,301 @@ static PyObject * message_nla_put(Message *self, PyObject *args) {
             return NULL;
     }
 
-    nla_put(self->msg, attribute_type, buffer.len, (void *) buffer.buf);
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL) {
+        PyBuffer_Release(&buffer);
+        return NULL;
+    }
+
+    nla_put(msg, attribute_type, buffer.len, (void *) buffer.buf);
 
     PyBuffer_Release(&buffer);
 
     Py_RETURN_NONE;
 }
 
-#define from_bytes_docs "A static method that creates a message object from bytes.\n@param bytes A full message bytes (header+payload)\n@return A new Message"
+/**
+ * Appends one typed attribute, the arguments are (type, value).
+ */
+static PyObject *message_put_typed(Message *self, PyObject *args, int policy_type) {
+    PyObject *value;
+    int type;
+
+    if (!PyArg_ParseTuple(args, "iO", &type, &value)) {
+        return NULL;
+    }
+
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL || attribute_encode(msg, type, policy_type, value) < 0) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define put_u8_docs "Adds an unsigned 8 bit attribute.\n@param type Attribute type\n@param value The value (int)"
+
+static PyObject *message_put_u8(Message *self, PyObject *args) {
+    return message_put_typed(self, args, NLA_U8);
+}
+
+#define put_u16_docs "Adds an unsigned 16 bit attribute.\n@param type Attribute type\n@param value The value (int)"
+
+static PyObject *message_put_u16(Message *self, PyObject *args) {
+    return message_put_typed(self, args, NLA_U16);
+}
+
+#define put_u32_docs "Adds an unsigned 32 bit attribute.\n@param type Attribute type\n@param value The value (int)"
+
+static PyObject *message_put_u32(Message *self, PyObject *args) {
+    return message_put_typed(self, args, NLA_U32);
+}
+
+#define put_u64_docs "Adds an unsigned 64 bit attribute.\n@param type Attribute type\n@param value The value (int)"
+
+static PyObject *message_put_u64(Message *self, PyObject *args) {
+    return message_put_typed(self, args, NLA_U64);
+}
+
+#define put_string_docs "Adds a null terminated string attribute.\n@param type Attribute type\n@param value The value (str)"
+
+static PyObject *message_put_string(Message *self, PyObject *args) {
+    return message_put_typed(self, args, NLA_STRING);
+}
+
+#define put_flag_docs "Adds a flag attribute (no payload).\n@param type Attribute type"
+
+static PyObject *message_put_flag(Message *self, PyObject *args) {
+    int type;
+
+    if (!PyArg_ParseTuple(args, "i", &type)) {
+        return NULL;
+    }
+
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL || attribute_encode(msg, type, NLA_FLAG, Py_True) < 0) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Picks the policy type of a value that has no policy.
+ *
+ * @return The policy type, -1 with an exception set if it can't be picked.
+ */
+static int infer_policy_type(int type, PyObject *value) {
+    if (PyBool_Check(value)) {
+        return NLA_FLAG;
+    } else if (PyUnicode_Check(value)) {
+        return NLA_STRING;
+    } else if (PyObject_CheckBuffer(value)) {
+        return NLA_UNSPEC;
+    } else if (PyDict_Check(value)) {
+        return NLA_NESTED;
+    }
+
+    PyErr_Format(PyExc_TypeError, "Attribute %d needs a policy to be encoded (%.100s)", type, Py_TYPE(value)->tp_name);
+    return -1;
+}
+
+/**
+ * Encodes (type, value) or (type, value, policy type) items.
+ * Without an explicit policy type the policies list is used (indexed by type), then the value's python type.
+ * NESTED values that are dicts or sequences of items are encoded recursively with the child policies.
+ *
+ * @param msg The message.
+ * @param items Iterable of items, or a dict of type to value.
+ * @param policies List of AttributePolicy indexed by type, NULL if none.
+ * @param depth Nesting depth.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int encode_items(struct nl_msg *msg, PyObject *items, PyObject *policies, int depth) {
+    if (depth >= POLICY_MAX_DEPTH) {
+        PyErr_SetString(PyExc_ValueError, "Attributes are nested too deep");
+        return -1;
+    }
+
+    PyObject *sequence = PyDict_Check(items) ? PyDict_Items(items) : PySequence_Fast(items, "attributes must be a dict or a sequence of (type, value) items");
+
+    if (sequence == NULL) {
+        return -1;
+    }
+
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    int ret = 0;
+
+    for (Py_ssize_t i = 0; i < count && ret == 0; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(sequence, i);
+        PyObject *children = NULL;
+        PyObject *value;
+        int policy_type = -1;
+        int type;
+
+        if (!PyTuple_Check(item) || !PyArg_ParseTuple(item, "iO|i", &type, &value, &policy_type)) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_TypeError, "attributes must be (type, value) or (type, value, policy type) tuples");
+            }
+
+            ret = -1;
+            break;
+        }
+
+        if (policy_type < 0 && policies != NULL && type >= 0 && type < PyList_GET_SIZE(policies)) {
+            AttributePolicy *policy = (AttributePolicy *) PyList_GET_ITEM(policies, type);
+
+            if (PyObject_TypeCheck(policy, &AttributePolicyType)) {
+                policy_type = policy->policy.type;
+                children = policy->nested;
+            }
+        }
+
+        if (policy_type < 0 && (policy_type = infer_policy_type(type, value)) < 0) {
+            ret = -1;
+            break;
+        }
+
+        if (policy_type == NLA_NESTED && !PyObject_CheckBuffer(value)) {
+            struct nlattr *start = nla_nest_start(msg, type);
+
+            if (start == NULL) {
+                PyErr_Format(PyExc_MemoryError, "Not enough room in the message for attribute %d", type);
+                ret = -1;
+                break;
+            }
+
+            ret = encode_items(msg, value, children != NULL && PyList_Check(children) ? children : NULL, depth + 1);
+            nla_nest_end(msg, start);
+        } else {
+            ret = attribute_encode(msg, type, policy_type, value);
+        }
+    }
+
+    Py_DECREF(sequence);
+
+    return ret;
+}
+
+#define put_many_docs "Adds many attributes in one call, the message is left unchanged if any of them fails.\nThe encoding of each attribute is picked by its explicit policy type, then by the policies, then by the value (bool -> flag, str -> string, bytes -> raw, dict -> nested).\nNESTED attributes take a dict or a sequence of items and are encoded with their child policies.\n@param items Sequence of (type, value) or (type, value, policy type)\n@param policies List of AttributePolicy indexed by type (optional)"
+
+static PyObject *message_put_many(Message *self, PyObject *args) {
+    PyObject *items;
+    PyObject *policies = NULL;
+
+    if (!PyArg_ParseTuple(args, "O|O!", &items, &PyList_Type, &policies)) {
+        return NULL;
+    }
+
+    struct nl_msg *msg = message_nl_msg(self);
+
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    struct nlmsghdr *nlh = nlmsg_hdr(msg);
+    uint32_t len = nlh->nlmsg_len;
+
+    if (encode_items(msg, items, policies, 0) < 0) {
+        // attributes are appended at nlmsg_len, so restoring it drops the partial ones.
+        memset((char *) nlh + len, 0, nlh->nlmsg_len - len);
+        nlh->nlmsg_len = len;
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define put_dict_docs "Adds the attributes of a dict in one call (see put_many).\n@param attributes dict of type to value\n@param policies List of AttributePolicy indexed by type (optional)"
+
+static PyObject *message_put_dict(Message *self, PyObject *args) {
+    PyObject *attributes;
+    PyObject *policies = NULL;
+
+    if (!PyArg_ParseTuple(args, "O!|O!", &PyDict_Type, &attributes, &PyList_Type, &policies)) {
+        return NULL;
+    }
+
+    PyObject *forward = Py_BuildValue(policies ? "(OO)" : "(O)", attributes, policies);
+
+    if (forward == NULL) {
+        return NULL;
+    }
+
+    PyObject *result = message_put_many(self, forward);
+    Py_DECREF(forward);
+
+    return result;
+}
+
+#define from_bytes_docs "A static method that creates a message object from bytes.\nThe buffer is wrapped, not copied (it is copied on the first write to the message), it must not change while the message is alive.\n@param bytes A full message bytes (header+payload), any object supporting the buffer protocol\n@return A new Message"
 
 static PyObject *message_from_bytes(PyObject *cls,  PyObject *args) {
+	PyObject *object;
 	Py_buffer buffer;
 
-	if (!PyArg_ParseTuple(args, "y*", &buffer)) {
+	if (!PyArg_ParseTuple(args, "O", &object)) {
+		return NULL;
+	}
+
+	if (PyObject_GetBuffer(object, &buffer, PyBUF_SIMPLE) < 0) {
 		return NULL;
 	}
-	
-	Message * message = PyObject_New(Message, &MessageType);
-	message->msg = nlmsg_alloc();
-	void *data = nlmsg_put(message->msg, NL_AUTO_PORT, NL_AUTO_SEQ, NLMSG_NOOP, buffer.len, 0);
-	memcpy(data, buffer.buf, buffer.len);
+
+	struct nlmsghdr *nlh = buffer.buf;
+	Message *message = NULL;
+
+	if (buffer.len < NLMSG_HDRLEN || nlh->nlmsg_len < NLMSG_HDRLEN || nlh->nlmsg_len > buffer.len) {
+		PyErr_SetString(PyExc_ValueError, "The buffer doesn't hold a full netlink message");
+	} else {
+		message = message_wrap((PyTypeObject *) cls, object, nlh);
+	}
 
 	PyBuffer_Release(&buffer);
 
 	return (PyObject *) message;
 }
 
+#define iter_stream_docs "A static method that iterates over the messages of a byte stream (a datagram, or recorded netlink traffic).\nThe messages wrap the stream's buffer like from_bytes, the walk stops at the first truncated message (see the iterator's offset).\n@param buffer The stream, any object supporting the buffer protocol\n@return iterator of the messages (StreamIterator)"
+
+static PyObject *message_iter_stream(PyObject *cls, PyObject *args) {
+	PyObject *object;
+
+	if (!PyArg_ParseTuple(args, "O", &object)) {
+		return NULL;
+	}
+
+	return (PyObject *) stream_iterator_new((PyTypeObject *) cls, object);
+}
+
+#define decode_stream_docs "A static method that splits a byte stream into messages in one pass.\nThe messages wrap the stream's buffer like from_bytes, the walk stops at the first truncated message.\n@param buffer The stream, any object supporting the buffer protocol\n@param index if true an index of tuples (offset, len, type, flags, seq, pid) is returned instead of messages\n@return list of the messages, or of the index tuples"
+
+static PyObject *message_decode_stream(PyObject *cls, PyObject *args) {
+	PyObject *object;
+	int index = 0;
+
+	if (!PyArg_ParseTuple(args, "O|p", &object, &index)) {
+		return NULL;
+	}
+
+	return stream_decode((PyTypeObject *) cls, object, index);
+}
+
 #define parse_header_docs "Parses the message's header (base NetLink level).\n@return A tuple of [len, type, flags, seq, pid]"
 
 static PyObject *message_parse_header(Message *self,  PyObject *args) {
-	struct nlmsghdr* nlh = nlmsg_hdr(self->msg);
+	struct nlmsghdr* nlh = message_hdr(self);
 
 	int len, type, flags, seq, pid;
 
+	if (nlh == NULL) {
+		PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+		return NULL;
+	}
+
 	len = nlh->nlmsg_len;
 	type = nlh->nlmsg_type;
 	flags = nlh->nlmsg_flags;
@@ -147,18 +667,161 @@ static PyObject *message_parse_header(Message *self,  PyObject *args) {
 	return result;
 }
 
-static PyObject *Message_new(PyTypeObject *type, PyObject *args,
-                             PyObject *kwds) {
-    Message *self;
+#define parse_ack_docs "Parses an ack (NLMSG_ERROR) into an Ack, with the extended ack's error message, invalid attribute offset,\ncookie and missing attribute when the kernel included them (see NetLink.set_ext_ack).\n@return Ack\n@raise ValueError if the message isn't an ack"
 
-    self = (Message *)type->tp_alloc(type, 0);
+static PyObject *message_parse_ack(Message *self, PyObject *Py_UNUSED(ignored)) {
+	struct nlmsghdr *nlh = message_hdr(self);
 
-    return (PyObject *)self;
+	if (nlh == NULL) {
+		PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+		return NULL;
+	}
+
+	return (PyObject *) ack_from_hdr(nlh);
+}
+
+#define reset_docs "Clears the message and puts a new header, the buffer is reused.\n@param family_id The family id.\n@param hdrlen Header length.\n@param flags flags."
+
+static PyObject *message_reset(Message *self, PyObject *args) {
+    int family_id;
+    int hdrlen;
+    int flags;
+
+    if (!PyArg_ParseTuple(args, "iii", &family_id, &hdrlen, &flags)) {
+        return NULL;
+    }
+
+    if (message_check_exports(self) < 0) {
+        return NULL;
+    }
+
+    if (self->msg == NULL && self->wrapped.obj == NULL) {
+        PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+        return NULL;
+    }
+
+    if (self->msg == NULL) {
+        // a wrapped message gets a buffer of its own, the foreign one is read only.
+        self->msg = message_pool_acquire(getpagesize());
+
+        if (self->msg == NULL) {
+            return PyErr_NoMemory();
+        }
+    }
+
+    message_pool_reset(self->msg);
+
+    if (!nlmsg_put(self->msg, NL_AUTO_PORT, NL_AUTO_SEQ, family_id, hdrlen, flags)) {
+        PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define pool_reserve_docs "A static method that preallocates message buffers.\n@param count Number of buffers\n@param size Size of the buffers, rounded up to a size class (default 4096)\n@return Number of buffers added to the pool"
+
+static PyObject *message_pool_reserve_method(PyObject *cls, PyObject *args) {
+    Py_ssize_t size = 4096;
+    int count;
+
+    if (!PyArg_ParseTuple(args, "i|n", &count, &size)) {
+        return NULL;
+    }
+
+    int ret = size < 0 ? -NLE_RANGE : message_pool_reserve(size, count);
+
+    if (ret < 0) {
+        PyErr_Format(PyExc_ValueError, "Can't preallocate the buffers: %s", nl_geterror(ret));
+        return NULL;
+    }
+
+    return PyLong_FromLong(ret);
+}
+
+#define pool_stats_docs "A static method that returns the counters of the message pools.\n@return dict with the keys object_hits, object_misses, objects_free, buffer_hits, buffer_misses and buffers_free (dict of buffer size to number of pooled buffers)"
+
+static PyObject *message_pool_stats(PyObject *cls, PyObject *args) {
+    struct message_pool_stats stats;
+
+    int objects_free = 0;
+
+    message_pool_get_stats(&stats);
+
+    for (int i = 0; i < MESSAGE_FREELIST_TYPES; i++) {
+        objects_free += freelists[i].len;
+    }
+
+    PyObject *buffers_free = PyDict_New();
+
+    if (buffers_free == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < MESSAGE_POOL_CLASSES; i++) {
+        PyObject *size = PyLong_FromSize_t(stats.sizes[i]);
+        PyObject *count = PyLong_FromLong(stats.free[i]);
+
+        if (size == NULL || count == NULL || PyDict_SetItem(buffers_free, size, count) < 0) {
+            Py_XDECREF(size);
+            Py_XDECREF(count);
+            Py_DECREF(buffers_free);
+            return NULL;
+        }
+
+        Py_DECREF(size);
+        Py_DECREF(count);
+    }
+
+    return Py_BuildValue("{s:k,s:k,s:i,s:k,s:k,s:N}", "object_hits", object_hits, "object_misses", object_misses,
+            "objects_free", objects_free, "buffer_hits", stats.hits, "buffer_misses", stats.misses, "buffers_free", buffers_free);
+}
+
+/**
+ * Exports exactly the message (nlmsg_len bytes) without copying it.
+ * The views of a wrapped message are read only, views of a borrowed message are exported by its owner.
+ */
+static int Message_getbuffer(Message *self, Py_buffer *view, int flags) {
+	Message *exporter = self->owner != NULL ? (Message *) self->owner : self;
+	struct nlmsghdr *nlh = message_hdr(exporter);
+
+	if (nlh == NULL) {
+		view->obj = NULL;
+		PyErr_SetString(PyExc_BufferError, "The message has no buffer");
+		return -1;
+	}
+
+	if (PyBuffer_FillInfo(view, (PyObject *) exporter, nlh, nlh->nlmsg_len, exporter->msg == NULL, flags) < 0) {
+		return -1;
+	}
+
+	exporter->exports++;
+
+	return 0;
+}
+
+static void Message_releasebuffer(Message *self, Py_buffer *view) {
+	self->exports--;
+}
+
+static PyBufferProcs Message_as_buffer = {
+    (getbufferproc) Message_getbuffer,
+    (releasebufferproc) Message_releasebuffer,
+};
+
+static PyObject *Message_new(PyTypeObject *type, PyObject *args,
+                             PyObject *kwds) {
+    return (PyObject *) message_alloc(type);
 }
 
 static void Message_dealloc(Message *self) {
-    if (self->msg != NULL) {
-        nlmsg_free(self->msg);
+    message_release_buffer(self);
+
+    struct message_freelist *freelist = find_freelist(Py_TYPE(self), 1);
+
+    if (freelist != NULL && freelist->len < MESSAGE_FREELIST_MAX) {
+        freelist->objects[freelist->len++] = self;
+        return;
     }
 
     Py_TYPE(self)->tp_free((PyObject *)self);
@@ -169,24 +832,37 @@ static void Message_dealloc(Message *self) {
  * @param hdrlen Header length.
  * @param flags flags.
  */
-static void Message_init(Message *self, PyObject *args, PyObject *kwds) {
+static int Message_init(Message *self, PyObject *args, PyObject *kwds) {
     int family_id;
     int hdrlen;
     int flags;
     
     if (PyArg_ParseTuple(args, "iii", &family_id, &hdrlen, &flags)) {
-	    self->msg = nlmsg_alloc();
+	    if (message_check_exports(self) < 0) {
+		    return -1;
+	    }
+
+	    // __init__ called again.
+	    message_release_buffer(self);
+
+	    self->msg = message_pool_acquire(getpagesize());
 
 	    if (!self->msg) {
 	       PyErr_SetString(PyExc_ConnectionRefusedError, "Can't allocate memory");
-	       return;
+	       return -1;
 	    } 
 
 	    if (!nlmsg_put(self->msg, NL_AUTO_PORT, NL_AUTO_SEQ, family_id, hdrlen, flags)) {
-		nlmsg_free(self->msg);
-		return;
+		message_pool_release(self->msg);
+		self->msg = NULL;
+		PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+		return -1;
 	    }
+
+	    return 0;
     }
+
+    return -1;
 }
 
 static PyMemberDef Message_members[] = {
@@ -198,11 +874,29 @@ static PyMethodDef Message_methods[] = {
     {"reserve", (PyCFunction) message_reserve, METH_VARARGS, reserve_docs},
     {"append", (PyCFunction) message_append, METH_VARARGS, append_docs},
     {"nla_put", (PyCFunction) message_nla_put, METH_VARARGS, nla_put_docs},
+    {"put_u8", (PyCFunction) message_put_u8, METH_VARARGS, put_u8_docs},
+    {"put_u16", (PyCFunction) message_put_u16, METH_VARARGS, put_u16_docs},
+    {"put_u32", (PyCFunction) message_put_u32, METH_VARARGS, put_u32_docs},
+    {"put_u64", (PyCFunction) message_put_u64, METH_VARARGS, put_u64_docs},
+    {"put_string", (PyCFunction) message_put_string, METH_VARARGS, put_string_docs},
+    {"put_flag", (PyCFunction) message_put_flag, METH_VARARGS, put_flag_docs},
+    {"put_many", (PyCFunction) message_put_many, METH_VARARGS, put_many_docs},
+    {"put_dict", (PyCFunction) message_put_dict, METH_VARARGS, put_dict_docs},
     {"get_bytes", (PyCFunction) message_get_bytes, METH_VARARGS, get_bytes_docs}, 
     {"parse_header", (PyCFunction) message_parse_header, METH_VARARGS, parse_header_docs},
+    {"parse_ack", (PyCFunction) message_parse_ack, METH_NOARGS, parse_ack_docs},
+    {"link_dump", (PyCFunction) rtnl_link_dump, METH_VARARGS | METH_KEYWORDS | METH_CLASS, link_dump_docs},
+    {"addr_dump", (PyCFunction) rtnl_addr_dump, METH_VARARGS | METH_KEYWORDS | METH_CLASS, addr_dump_docs},
+    {"route_dump", (PyCFunction) rtnl_route_dump, METH_VARARGS | METH_KEYWORDS | METH_CLASS, route_dump_docs},
+    {"neigh_dump", (PyCFunction) rtnl_neigh_dump, METH_VARARGS | METH_KEYWORDS | METH_CLASS, neigh_dump_docs},
     {"nla_nest_start", (PyCFunction) message_nla_nested_start, METH_VARARGS, parse_header_docs},
     {"nla_nest_end", (PyCFunction) message_nla_nested_end, METH_VARARGS, parse_header_docs},
     {"from_bytes", (PyCFunction) message_from_bytes, METH_VARARGS | METH_CLASS, from_bytes_docs},
+    {"iter_stream", (PyCFunction) message_iter_stream, METH_VARARGS | METH_CLASS, iter_stream_docs},
+    {"decode_stream", (PyCFunction) message_decode_stream, METH_VARARGS | METH_CLASS, decode_stream_docs},
+    {"reset", (PyCFunction) message_reset, METH_VARARGS, reset_docs},
+    {"pool_reserve", (PyCFunction) message_pool_reserve_method, METH_VARARGS | METH_CLASS, pool_reserve_docs},
+    {"pool_stats", (PyCFunction) message_pool_stats, METH_NOARGS | METH_CLASS, pool_stats_docs},
     {NULL} /* Sentinel */
 };
 
@@ -224,7 +918,7 @@ PyTypeObject MessageType = {
     0,                                                /* tp_str */
     0,                                                /* tp_getattro */
     0,                                                /* tp_setattro */
-    0,                                                /* tp_as_buffer */
+    &Message_as_buffer,                               /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,                               /* tp_flags */
     "Client implmentation of the netlink kenrel interface.", /* tp_doc */
     0,                                                       /* tp_traverse */
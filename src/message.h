@@ -22,15 +22,100 @@
 #include "Python.h"
 #include <structmember.h>
 #include "netlink.h"
+#include "message_pool.h"
+
+// maximum number of Message objects kept for reuse.
+#define MESSAGE_FREELIST_MAX 256
+
+// number of message types (Message and its C subclasses) that get a free list.
+#define MESSAGE_FREELIST_TYPES 2
 
 /**
  * Represents NetLink class.
+ *
+ * msg -> The message buffer, NULL while the message only wraps a foreign buffer.
+ * owner -> The message msg is borrowed from (kept alive by this one), NULL if msg is owned.
+ * wrapped -> The foreign buffer wrapped by from_bytes, wrapped.obj is NULL if none.
+ *            It is kept after the message is copied into msg (on the first write), for the views into it.
+ *            A borrowed message holds an export of its owner there, so the owner can't replace msg.
+ * exports -> Number of buffer views exported by the message (buffer protocol).
  */
 typedef struct {
     PyObject_HEAD
     struct nl_msg *msg;
+    PyObject *owner;
+    Py_buffer wrapped;
+    Py_ssize_t exports;
 } Message; 
 
 extern PyTypeObject MessageType;
 
+/**
+ * Creates an empty Message (without a buffer), reusing a freed one when possible.
+ *
+ * @param type MessageType or one of its C subclasses.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_alloc(PyTypeObject *type);
+
+/**
+ * Creates a Message holding a copy of a raw message, the copy is taken from the buffer pool.
+ *
+ * @param hdr The raw message.
+ * @param type MessageType or one of its C subclasses.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_from_hdr(struct nlmsghdr *hdr, PyTypeObject *type);
+
+/**
+ * Creates a Message that wraps a message inside a foreign buffer (no copy).
+ * The message is copied instead if it is misaligned.
+ *
+ * @param type MessageType or one of its C subclasses.
+ * @param object The object exporting the buffer, kept alive by the message.
+ * @param hdr The message, a full message inside the object's buffer.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+Message *message_wrap(PyTypeObject *type, PyObject *object, struct nlmsghdr *hdr);
+
+/**
+ * Returns the raw message, in msg or in the wrapped buffer.
+ *
+ * @param self The message.
+ * @return The raw message, NULL if the message has no buffer.
+ */
+struct nlmsghdr *message_hdr(Message *self);
+
+/**
+ * Returns the message's nl_msg for writing or sending,
+ * a message that wraps a foreign buffer is copied into a pooled buffer first.
+ *
+ * @param self The message.
+ * @return The nl_msg, NULL with an exception set upon failure.
+ */
+struct nl_msg *message_nl_msg(Message *self);
+
+/**
+ * Fails if views of the message's buffer are exported, before the buffer is replaced.
+ *
+ * @param self The message.
+ * @return zero if not exported, -1 with an exception set otherwise.
+ */
+int message_check_exports(Message *self);
+
+/**
+ * Invalidates a callback scoped view once its callback returned.
+ * The buffer is dropped, unless views of it are still exported (then it stays valid).
+ *
+ * @param self The message.
+ */
+void message_invalidate(Message *self);
+
+/**
+ * Drops the message's buffer, giving it back to the pool if the message owns it.
+ *
+ * @param self The message.
+ */
+void message_release_buffer(Message *self);
+
 #endif
@@ -0,0 +1,187 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "message_pool.h"
+
+/**
+ * A size class.
+ *
+ * size -> Size of the buffers.
+ * max -> Maximum number of pooled buffers.
+ * len -> Number of pooled buffers.
+ * buffers -> The pooled buffers.
+ */
+struct pool_class {
+    size_t size;
+    int max;
+    int len;
+    struct nl_msg **buffers;
+};
+
+// the bounds keep the memory held by each class at about 512KB.
+static struct pool_class classes[MESSAGE_POOL_CLASSES] = {
+    { .size = 4096, .max = 128 },
+    { .size = 16384, .max = 32 },
+    { .size = 65536, .max = 8 },
+};
+
+static unsigned long hits;
+static unsigned long misses;
+
+/**
+ * Finds the smallest class fitting a size.
+ *
+ * @param size The size.
+ * @return The class, NULL if the size is bigger than every class.
+ */
+static struct pool_class *find_class(size_t size) {
+    for (int i = 0; i < MESSAGE_POOL_CLASSES; i++) {
+        if (size <= classes[i].size) {
+            return &classes[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Clears a buffer, leaving an empty header as nlmsg_alloc does.
+ *
+ * @param msg The buffer.
+ */
+void message_pool_reset(struct nl_msg *msg) {
+    struct nlmsghdr *nlh = nlmsg_hdr(msg);
+    size_t used = NLMSG_ALIGN(nlh->nlmsg_len);
+    size_t size = nlmsg_get_max_size(msg);
+
+    // nlmsg_alloc hands out zeroed buffers, and Message relies on that for the user header.
+    memset(nlh, 0, used < size ? used : size);
+    nlh->nlmsg_len = NLMSG_HDRLEN;
+}
+
+/**
+ * Takes a cleared buffer from the pool, allocating one if the pool is empty.
+ *
+ * @param size Minimum size of the buffer (header included).
+ * @return The buffer, NULL upon failure.
+ */
+struct nl_msg *message_pool_acquire(size_t size) {
+    struct pool_class *class = find_class(size);
+
+    if (class == NULL) {
+        misses++;
+        return nlmsg_alloc_size(size);
+    }
+
+    if (class->len > 0) {
+        hits++;
+        return class->buffers[--class->len];
+    }
+
+    misses++;
+
+    return nlmsg_alloc_size(class->size);
+}
+
+/**
+ * Gives a buffer back to the pool, the buffer is freed if its class is full.
+ *
+ * @param msg The buffer, must not be referenced anywhere else.
+ */
+void message_pool_release(struct nl_msg *msg) {
+    struct pool_class *class = find_class(nlmsg_get_max_size(msg));
+
+    if (class == NULL || class->size != nlmsg_get_max_size(msg) || class->len == class->max) {
+        nlmsg_free(msg);
+        return;
+    }
+
+    if (class->buffers == NULL && (class->buffers = malloc(class->max * sizeof(struct nl_msg *))) == NULL) {
+        nlmsg_free(msg);
+        return;
+    }
+
+    message_pool_reset(msg);
+    class->buffers[class->len++] = msg;
+}
+
+/**
+ * Copies a raw message into a buffer of the pool (the pooled nlmsg_convert).
+ *
+ * @param hdr The raw message.
+ * @return The buffer, NULL upon failure.
+ */
+struct nl_msg *message_pool_convert(struct nlmsghdr *hdr) {
+    struct nl_msg *msg = message_pool_acquire(NLMSG_ALIGN(hdr->nlmsg_len));
+
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    memcpy(nlmsg_hdr(msg), hdr, hdr->nlmsg_len);
+
+    return msg;
+}
+
+/**
+ * Preallocates buffers.
+ *
+ * @param size Size of the buffers, rounded up to the size of its class.
+ * @param count Number of buffers.
+ * @return Number of buffers added to the pool, negative error code upon failure.
+ */
+int message_pool_reserve(size_t size, int count) {
+    struct pool_class *class = find_class(size);
+    int added = 0;
+
+    if (class == NULL) {
+        return -NLE_RANGE;
+    }
+
+    if (class->buffers == NULL && (class->buffers = malloc(class->max * sizeof(struct nl_msg *))) == NULL) {
+        return -NLE_NOMEM;
+    }
+
+    while (added < count && class->len < class->max) {
+        struct nl_msg *msg = nlmsg_alloc_size(class->size);
+
+        if (msg == NULL) {
+            return added > 0 ? added : -NLE_NOMEM;
+        }
+
+        class->buffers[class->len++] = msg;
+        added++;
+    }
+
+    return added;
+}
+
+/**
+ * Gets the pool counters.
+ *
+ * @param stats Filled with the counters.
+ */
+void message_pool_get_stats(struct message_pool_stats *stats) {
+    stats->hits = hits;
+    stats->misses = misses;
+
+    for (int i = 0; i < MESSAGE_POOL_CLASSES; i++) {
+        stats->free[i] = classes[i].len;
+        stats->sizes[i] = classes[i].size;
+    }
+}
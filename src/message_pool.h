@@ -0,0 +1,100 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Free lists of nl_msg buffers, one per size class.
+ *
+ * Released buffers are cleared and kept (up to a bound per class) instead of being freed,
+ * so building and receiving messages doesn't hit the allocator on every message.
+ * Buffers bigger than the biggest class are never pooled.
+ *
+ * The pool isn't locked, every function must be called with the GIL held.
+ */
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include <netlink/netlink.h>
+#include <netlink/msg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGE_POOL_CLASSES 3
+
+/**
+ * Counters of the pool.
+ *
+ * hits -> Buffers taken from the pool.
+ * misses -> Buffers that had to be allocated.
+ * free -> Buffers currently pooled, per size class.
+ * sizes -> Size of every class.
+ */
+struct message_pool_stats {
+    unsigned long hits;
+    unsigned long misses;
+    int free[MESSAGE_POOL_CLASSES];
+    size_t sizes[MESSAGE_POOL_CLASSES];
+};
+
+/**
+ * Takes a cleared buffer from the pool, allocating one if the pool is empty.
+ *
+ * @param size Minimum size of the buffer (header included).
+ * @return The buffer, NULL upon failure.
+ */
+struct nl_msg *message_pool_acquire(size_t size);
+
+/**
+ * Gives a buffer back to the pool, the buffer is freed if its class is full.
+ *
+ * @param msg The buffer, must not be referenced anywhere else.
+ */
+void message_pool_release(struct nl_msg *msg);
+
+/**
+ * Copies a raw message into a buffer of the pool (the pooled nlmsg_convert).
+ *
+ * @param hdr The raw message.
+ * @return The buffer, NULL upon failure.
+ */
+struct nl_msg *message_pool_convert(struct nlmsghdr *hdr);
+
+/**
+ * Clears a buffer, leaving an empty header as nlmsg_alloc does.
+ *
+ * @param msg The buffer.
+ */
+void message_pool_reset(struct nl_msg *msg);
+
+/**
+ * Preallocates buffers.
+ *
+ * @param size Size of the buffers, rounded up to the size of its class.
+ * @param count Number of buffers.
+ * @return Number of buffers added to the pool, negative error code upon failure.
+ */
+int message_pool_reserve(size_t size, int count);
+
+/**
+ * Gets the pool counters.
+ *
+ * @param stats Filled with the counters.
+ */
+void message_pool_get_stats(struct message_pool_stats *stats);
+
+#endif
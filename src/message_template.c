@@ -0,0 +1,362 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "message_template.h"
+#include "attribute.h"
+
+/**
+ * Payload size of the fixed size policy types, -1 for the others.
+ */
+static int fixed_payload_size(int policy_type) {
+    switch (policy_type) {
+    case NLA_U8:
+    case NLA_S8:
+        return 1;
+    case NLA_U16:
+    case NLA_S16:
+        return 2;
+    case NLA_U32:
+    case NLA_S32:
+        return 4;
+    case NLA_U64:
+    case NLA_S64:
+    case NLA_MSECS:
+        return 8;
+    case NLA_FLAG:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Computes the size of a message built from values, the values are checked to be encodable on the way.
+ *
+ * @param self The template.
+ * @param values The values, one per attribute.
+ * @return The size, -1 with an exception set upon failure.
+ */
+static Py_ssize_t template_message_size(MessageTemplate *self, PyObject **values) {
+    Py_ssize_t size = self->fixed_size;
+
+    for (int i = 0; i < self->attributes_len; i++) {
+        struct template_attribute *attribute = &self->attributes[i];
+        PyObject *value = values[i];
+        Py_ssize_t len;
+
+        if (attribute->size >= 0 || value == Py_None) {
+            continue;
+        }
+
+        if (attribute->policy_type == NLA_STRING || attribute->policy_type == NLA_NUL_STRING) {
+            if (!PyUnicode_Check(value) || PyUnicode_AsUTF8AndSize(value, &len) == NULL) {
+                if (!PyErr_Occurred()) {
+                    PyErr_Format(PyExc_TypeError, "String attributes take a str, not %.100s", Py_TYPE(value)->tp_name);
+                }
+
+                return -1;
+            }
+
+            len++;
+        } else {
+            Py_buffer buffer;
+
+            if (PyObject_GetBuffer(value, &buffer, PyBUF_SIMPLE) < 0) {
+                return -1;
+            }
+
+            len = buffer.len;
+            PyBuffer_Release(&buffer);
+        }
+
+        size += nla_total_size(len);
+    }
+
+    return size;
+}
+
+/**
+ * Encodes one message from a sequence of values.
+ *
+ * @param self The template.
+ * @param values A sequence with one value per attribute, None skips the attribute.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+static Message *template_encode(MessageTemplate *self, PyObject *values) {
+    PyObject *sequence = PySequence_Fast(values, "values must be a sequence");
+
+    if (sequence == NULL) {
+        return NULL;
+    }
+
+    if (PySequence_Fast_GET_SIZE(sequence) != self->attributes_len) {
+        PyErr_Format(PyExc_ValueError, "The template has %d attributes, got %zd values", self->attributes_len, PySequence_Fast_GET_SIZE(sequence));
+        Py_DECREF(sequence);
+        return NULL;
+    }
+
+    PyObject **items = PySequence_Fast_ITEMS(sequence);
+    Py_ssize_t size = template_message_size(self, items);
+    Message *message = size < 0 ? NULL : message_alloc(&MessageType);
+
+    if (message == NULL) {
+        Py_DECREF(sequence);
+        return NULL;
+    }
+
+    message->msg = message_pool_acquire(size);
+
+    if (message->msg == NULL || !nlmsg_put(message->msg, NL_AUTO_PORT, NL_AUTO_SEQ, self->family_id, self->hdrlen, self->flags)) {
+        PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+        goto error;
+    }
+
+    memcpy(nlmsg_data(nlmsg_hdr(message->msg)), self->header, self->hdrlen);
+
+    for (int i = 0; i < self->attributes_len; i++) {
+        struct template_attribute *attribute = &self->attributes[i];
+
+        if (items[i] == Py_None) {
+            continue;
+        }
+
+        if (attribute_encode(message->msg, attribute->type, attribute->policy_type, items[i]) < 0) {
+            goto error;
+        }
+    }
+
+    Py_DECREF(sequence);
+
+    return message;
+
+error:
+    Py_DECREF(sequence);
+    Py_DECREF(message);
+
+    return NULL;
+}
+
+#define encode_docs "Encodes a message.\n@param values A tuple with one value per attribute (in the template's order), None skips the attribute\n@return A new Message"
+
+static PyObject *message_template_encode(MessageTemplate *self, PyObject *args) {
+    PyObject *values;
+
+    if (!PyArg_ParseTuple(args, "O", &values)) {
+        return NULL;
+    }
+
+    return (PyObject *) template_encode(self, values);
+}
+
+#define encode_many_docs "Encodes many messages, ready for NetLink.send_batch.\n@param rows A sequence of value tuples (see encode)\n@return A list of new Messages"
+
+static PyObject *message_template_encode_many(MessageTemplate *self, PyObject *args) {
+    PyObject *rows;
+
+    if (!PyArg_ParseTuple(args, "O", &rows)) {
+        return NULL;
+    }
+
+    PyObject *sequence = PySequence_Fast(rows, "rows must be a sequence");
+
+    if (sequence == NULL) {
+        return NULL;
+    }
+
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    PyObject *messages = PyList_New(count);
+
+    for (Py_ssize_t i = 0; messages != NULL && i < count; i++) {
+        Message *message = template_encode(self, PySequence_Fast_GET_ITEM(sequence, i));
+
+        if (message == NULL) {
+            Py_CLEAR(messages);
+            break;
+        }
+
+        PyList_SET_ITEM(messages, i, (PyObject *) message);
+    }
+
+    Py_DECREF(sequence);
+
+    return messages;
+}
+
+static PyObject *MessageTemplate_new(PyTypeObject *type, PyObject *args,
+                             PyObject *kwds) {
+    MessageTemplate *self;
+
+    self = (MessageTemplate *)type->tp_alloc(type, 0);
+
+    return (PyObject *)self;
+}
+
+static void MessageTemplate_dealloc(MessageTemplate *self) {
+    free(self->header);
+    free(self->attributes);
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/**
+ * Compiles the template.
+ *
+ * @param family_id The family id (message type).
+ * @param flags The message flags.
+ * @param attributes The attributes in encoding order, a list of (type, policy type) tuples.
+ * @param header The user header, copied as is into every message (default empty).
+ * @param cmd Generic netlink command, when set the generic netlink header (cmd, version) is the user header.
+ * @param version Generic netlink family version (default 0).
+ */
+static int MessageTemplate_init(MessageTemplate *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"family_id", "flags", "attributes", "header", "cmd", "version", NULL};
+    Py_buffer header = {0};
+    PyObject *attributes;
+    int family_id;
+    int flags;
+    int cmd = -1;
+    int version = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iiO|y*ii", kwlist, &family_id, &flags, &attributes, &header, &cmd, &version)) {
+        return -1;
+    }
+
+    // fixed_size (an int) holds the aligned header along with the netlink header.
+    if (header.len > INT_MAX - NLMSG_HDRLEN - NLMSG_ALIGNTO) {
+        PyBuffer_Release(&header);
+        PyErr_SetString(PyExc_ValueError, "The header is too long");
+        return -1;
+    }
+
+    PyObject *sequence = PySequence_Fast(attributes, "attributes must be a sequence of (type, policy type) tuples");
+
+    if (sequence == NULL) {
+        PyBuffer_Release(&header);
+        return -1;
+    }
+
+    free(self->header);
+    free(self->attributes);
+
+    self->family_id = family_id;
+    self->flags = flags;
+    self->attributes_len = PySequence_Fast_GET_SIZE(sequence);
+    self->hdrlen = cmd >= 0 ? (int) GENL_HDRLEN : (int) header.len;
+    self->header = calloc(self->hdrlen > 0 ? self->hdrlen : 1, 1);
+    self->attributes = calloc(self->attributes_len > 0 ? self->attributes_len : 1, sizeof(struct template_attribute));
+
+    if (self->header == NULL || self->attributes == NULL) {
+        PyBuffer_Release(&header);
+        Py_DECREF(sequence);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (cmd >= 0) {
+        struct genlmsghdr genl = {
+            .cmd = cmd,
+            .version = version,
+        };
+
+        memcpy(self->header, &genl, GENL_HDRLEN);
+    } else if (header.len > 0) {
+        memcpy(self->header, header.buf, header.len);
+    }
+
+    PyBuffer_Release(&header);
+
+    self->fixed_size = NLMSG_HDRLEN + NLMSG_ALIGN(self->hdrlen);
+
+    for (int i = 0; i < self->attributes_len; i++) {
+        struct template_attribute *attribute = &self->attributes[i];
+        PyObject *item = PySequence_Fast_GET_ITEM(sequence, i);
+
+        if (!PyTuple_Check(item) || !PyArg_ParseTuple(item, "ii", &attribute->type, &attribute->policy_type)) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_TypeError, "attributes must be (type, policy type) tuples");
+            }
+
+            Py_DECREF(sequence);
+            return -1;
+        }
+
+        attribute->size = fixed_payload_size(attribute->policy_type);
+
+        if (attribute->size >= 0) {
+            self->fixed_size += nla_total_size(attribute->size);
+        }
+    }
+
+    Py_DECREF(sequence);
+
+    return 0;
+}
+
+static PyMemberDef MessageTemplate_members[] = {
+    {"family_id", T_INT, offsetof(MessageTemplate, family_id), READONLY, "The family id (message type)."},
+    {"flags", T_INT, offsetof(MessageTemplate, flags), READONLY, "The message flags."},
+    {"hdrlen", T_INT, offsetof(MessageTemplate, hdrlen), READONLY, "Length of the user header."},
+    {"fixed_size", T_INT, offsetof(MessageTemplate, fixed_size), READONLY, "Size of a message without its strings and raw payloads."},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef MessageTemplate_methods[] = {
+    {"encode", (PyCFunction) message_template_encode, METH_VARARGS, encode_docs},
+    {"encode_many", (PyCFunction) message_template_encode_many, METH_VARARGS, encode_many_docs},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject MessageTemplateType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.MessageTemplate", /* tp_name */
+    sizeof(MessageTemplate),                          /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)MessageTemplate_dealloc,              /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                               /* tp_flags */
+    "A message shape (header and ordered attributes) compiled once, encodes a whole message from a tuple of values in one call.", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    0,                      /* tp_iter */
+    0,                      /* tp_iternext */
+    MessageTemplate_methods, /* tp_methods */
+    MessageTemplate_members, /* tp_members */
+    0,                      /* tp_getset */
+    0,                      /* tp_base */
+    0,                      /* tp_dict */
+    0,                      /* tp_descr_get */
+    0,                      /* tp_descr_set */
+    0,                      /* tp_dictoffset */
+    (initproc)MessageTemplate_init, /* tp_init */
+    0,                      /* tp_alloc */
+    MessageTemplate_new,    /* tp_new */
+};
@@ -0,0 +1,64 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MESSAGE_TEMPLATE_H
+#define MESSAGE_TEMPLATE_H
+
+#include "Python.h"
+#include <structmember.h>
+#include "netlink.h"
+#include "message.h"
+
+/**
+ * An attribute of a template.
+ *
+ * type -> The attribute type.
+ * policy_type -> How the value is encoded (NLA_*).
+ * size -> Payload size of fixed size types, -1 for strings and raw payloads.
+ */
+struct template_attribute {
+    int type;
+    int policy_type;
+    int size;
+};
+
+/**
+ * Represents a message shape compiled once and encoded many times.
+ *
+ * family_id -> The message type.
+ * flags -> The message flags.
+ * header -> The user header (the generic netlink header for example), copied as is into every message.
+ * hdrlen -> Length of the user header.
+ * attributes_len -> Number of attributes.
+ * attributes -> The attributes, in encoding order.
+ * fixed_size -> Size of a message without its variable size payloads.
+ */
+typedef struct {
+    PyObject_HEAD
+    int family_id;
+    int flags;
+    unsigned char *header;
+    int hdrlen;
+    int attributes_len;
+    struct template_attribute *attributes;
+    int fixed_size;
+} MessageTemplate;
+
+extern PyTypeObject MessageTemplateType;
+
+#endif
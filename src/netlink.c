@@ -37,7 +37,9 @@ struct netlink *initialize_netlink(struct netlink *nl, int protocol, int family_
     nl->protocol = protocol;
     nl->family_id = family_id;
     nl->policies_len = policies_len;
-    nl->policies = malloc(sizeof(struct nla_policy) * policies_len);
+    nl->overruns = 0;
+    // nlmsg_parse indexes the policies by attribute type up to policies_len (inclusive).
+    nl->policies = calloc(policies_len + 1, sizeof(struct nla_policy));
     for (int i = 0; i < policies_len; i++) {
 	    nl->policies[i] = policies[i];
     }
@@ -53,12 +55,17 @@ struct netlink *initialize_netlink(struct netlink *nl, int protocol, int family_
  * Resolves a family id from the family_name.
  * 
  * !Note Only for generic netlink ofcourse.
+ * The id comes from the process wide families cache (see genl_cache.h).
  *
  * @param family_name The family name to resolve.
  * @returns the family id.
  */
 int resolve_genl_family_id(char* family_name) {
-	int family_id;
+	int family_id = genl_cache_family_id(family_name);
+
+	// the cache is unusable (no controller socket), ask the controller directly.
+	if (family_id >= 0 || family_id == -NLE_OBJ_NOTFOUND) return family_id;
+
 	struct nl_sock * sock = nl_socket_alloc();
 	if (!sock) return -1;
 
@@ -80,7 +87,10 @@ int resolve_genl_family_id(char* family_name) {
  * @returns the group id.
  */
 int resolve_genl_group_id(char* family_name, char* group_name) {
-	int family_id;
+	int family_id = genl_cache_group_id(family_name, group_name);
+
+	if (family_id >= 0 || family_id == -NLE_OBJ_NOTFOUND) return family_id;
+
 	struct nl_sock * sock = nl_socket_alloc();
 	if (!sock) return -1;
 
@@ -102,20 +112,20 @@ int resolve_genl_group_id(char* family_name, char* group_name) {
  * @param type callback's type.
  * @param kind callback's kind.
  * @param arg arguments to add when calling the callback.
+ * @return zero upon success, negative error code upon failure.
  */
-void modify_cb(struct netlink *nl, enum nl_cb_type type, enum nl_cb_kind kind, void *callback, void *arg) {
-	nl_socket_modify_cb(nl->sock, NL_CB_VALID, NL_CB_CUSTOM, callback, arg);
+int modify_cb(struct netlink *nl, enum nl_cb_type type, enum nl_cb_kind kind, void *callback, void *arg) {
+	return nl_socket_modify_cb(nl->sock, type, kind, callback, arg);
 }
 
 /**
  * Parses attributes from a message.
  *
  * @param nl netlink object.
- * @param msg message to parse.
+ * @param nlh message to parse.
  * @param attrs attributes array in length of 1+MAX_ATTRIBUTE, the parsed attributes will be put there.
  */
-void parse_attr_nl(struct netlink *nl, struct nl_msg *msg, struct nlattr **attrs) {
-    struct nlmsghdr *nlh = nlmsg_hdr(msg);
+void parse_attr_nl(struct netlink *nl, struct nlmsghdr *nlh, struct nlattr **attrs) {
     int ret;
 
   
@@ -172,16 +182,110 @@ int send_nl(struct netlink *nl, struct nl_msg *msg) {
     return ret;
 }
 
+/**
+ * Sends many messages with as few sendmsg calls as possible.
+ * Every message is completed first (port, sequence number and flags), so the sequence numbers
+ * are assigned in one go, then the messages are packed into iovecs up to the socket's send buffer and IOV_MAX.
+ *
+ * !Note Doesn't touch any python object, so it may be called without holding the GIL.
+ *
+ * @param nl netlink object.
+ * @param msgs messages to send.
+ * @param count number of messages.
+ * @param ack which messages request an ack (batch_ack).
+ * @param seqs filled with the sequence number of every message.
+ * @return number of sendmsg calls, negative error code upon failure.
+ */
+int send_batch_nl(struct netlink *nl, struct nl_msg **msgs, int count, enum batch_ack ack, unsigned int *seqs) {
+    struct iovec iov[IOV_MAX];
+    int sndbuf = 0;
+    socklen_t optlen = sizeof(sndbuf);
+    size_t limit;
+    int sends = 0;
+
+    if (getsockopt(nl_socket_get_fd(nl->sock), SOL_SOCKET, SO_SNDBUF, &sndbuf, &optlen) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    // the kernel refuses datagrams bigger than the send buffer minus its own overhead.
+    limit = sndbuf > 64 ? sndbuf - 32 : sndbuf;
+
+    for (int i = 0; i < count; i++) {
+        struct nlmsghdr *nlh = nlmsg_hdr(msgs[i]);
+
+        nl_complete_msg(nl->sock, msgs[i]);
+
+        if (ack == BATCH_ACK_ALL || (ack == BATCH_ACK_LAST && i == count - 1)) {
+            nlh->nlmsg_flags |= NLM_F_ACK;
+        } else if (ack == BATCH_ACK_LAST) {
+            nlh->nlmsg_flags &= ~NLM_F_ACK;
+        }
+
+        seqs[i] = nlh->nlmsg_seq;
+    }
+
+    for (int first = 0; first < count;) {
+        size_t total = 0;
+        int iovlen = 0;
+
+        while (first + iovlen < count && iovlen < IOV_MAX) {
+            struct nlmsghdr *nlh = nlmsg_hdr(msgs[first + iovlen]);
+            size_t len = NLMSG_ALIGN(nlh->nlmsg_len);
+
+            if (iovlen > 0 && total + len > limit) {
+                break;
+            }
+
+            iov[iovlen].iov_base = nlh;
+            iov[iovlen].iov_len = len;
+            total += len;
+            iovlen++;
+        }
+
+        int ret = nl_send_iovec(nl->sock, msgs[first], iov, iovlen);
+
+        if (ret < 0) {
+            return ret;
+        }
+
+        sends++;
+        first += iovlen;
+    }
+
+    return sends;
+}
+
+/**
+ * Returns the current time in milliseconds (monotonic).
+ */
+long long monotonic_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 /**
  * Recieves a message.
+ * An overrun is counted in nl->overruns.
  *
  * @param nl netlink object
- * @return return code, zero upon success.
+ * @return return code, zero upon success, -NLE_NOMEM if the receive buffer overran, -NLE_RECV_NOMEM if out of memory.
  */
 int recv_nl(struct netlink *nl)
 {
     int ret = nl_recvmsgs_default(nl->sock);
 
+    if (ret == -NLE_NOMEM) {
+        if (errno != ENOBUFS) {
+            return -NLE_RECV_NOMEM;
+        }
+
+        nl->overruns++;
+        return ret;
+    }
+
     if (ret < 0 && ret != -4) {
 	        printf("Failed to receive netlink message: %s\n", nl_geterror(ret));
         	fprintf(stderr, "Error: Failed to receive netlink message %d\n", ret);
@@ -191,6 +295,401 @@ int recv_nl(struct netlink *nl)
     return ret;
 }
 
+/**
+ * Sets the socket's receive buffer size (SO_RCVBUF).
+ *
+ * @param nl netlink object.
+ * @param size requested size in bytes, the kernel doubles it for its bookkeeping.
+ * @param force use SO_RCVBUFFORCE to go over net.core.rmem_max (needs CAP_NET_ADMIN).
+ * @return the effective size, negative error code upon failure.
+ */
+int set_rcvbuf_nl(struct netlink *nl, int size, int force) {
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_SOCKET, force ? SO_RCVBUFFORCE : SO_RCVBUF, &size, sizeof(size)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return get_rcvbuf_nl(nl);
+}
+
+/**
+ * Gets the socket's receive buffer size (SO_RCVBUF).
+ *
+ * @param nl netlink object.
+ * @return the size in bytes, negative error code upon failure.
+ */
+int get_rcvbuf_nl(struct netlink *nl) {
+    int size = 0;
+    socklen_t optlen = sizeof(size);
+
+    if (getsockopt(nl_socket_get_fd(nl->sock), SOL_SOCKET, SO_RCVBUF, &size, &optlen) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return size;
+}
+
+/**
+ * Enables or disables NETLINK_NO_ENOBUFS.
+ * When enabled the kernel doesn't report overruns caused by multicast deliveries, the messages are still lost.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_no_enobufs_nl(struct netlink *nl, int enable) {
+    enable = !!enable;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_NETLINK, NETLINK_NO_ENOBUFS, &enable, sizeof(enable)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Enables or disables NETLINK_CAP_ACK.
+ * When enabled the acks echo only the header of the request instead of the whole request.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_cap_ack_nl(struct netlink *nl, int enable) {
+    enable = !!enable;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_NETLINK, NETLINK_CAP_ACK, &enable, sizeof(enable)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Enables or disables NETLINK_EXT_ACK.
+ * When enabled the errors carry attributes describing them (error message, offset of the invalid attribute...).
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_ext_ack_nl(struct netlink *nl, int enable) {
+    enable = !!enable;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_NETLINK, NETLINK_EXT_ACK, &enable, sizeof(enable)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Enables or disables NETLINK_GET_STRICT_CHK.
+ * When enabled the kernel validates the headers of the dump requests strictly and applies their filters itself.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_strict_check_nl(struct netlink *nl, int enable) {
+    enable = !!enable;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_NETLINK, NETLINK_GET_STRICT_CHK, &enable, sizeof(enable)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Attaches a classic BPF program to the socket (SO_ATTACH_FILTER), replacing the current one.
+ * The kernel runs it on every datagram before queueing it, the dropped datagrams are never copied to userspace.
+ *
+ * @param nl netlink object.
+ * @param code the program.
+ * @param len number of instructions.
+ * @return zero upon success, negative error code upon failure.
+ */
+int attach_filter_nl(struct netlink *nl, struct sock_filter *code, int len) {
+    struct sock_fprog program = {
+        .len = len,
+        .filter = code,
+    };
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Detaches the socket's BPF program (SO_DETACH_FILTER).
+ *
+ * @param nl netlink object.
+ * @return zero upon success, negative error code upon failure (-NLE_OBJ_NOTFOUND if there is none).
+ */
+int detach_filter_nl(struct netlink *nl) {
+    int unused = 0;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_SOCKET, SO_DETACH_FILTER, &unused, sizeof(unused)) < 0) {
+        return errno == ENOENT ? -NLE_OBJ_NOTFOUND : -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Sets the size of the buffer libnl receives into, and whether it peeks at the datagram size first.
+ * Without peeking a datagram bigger than the buffer is truncated.
+ *
+ * @param nl netlink object.
+ * @param size buffer size in bytes, zero for the page size.
+ * @param peek non zero to peek (MSG_PEEK) before every read.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_recv_buffer_nl(struct netlink *nl, size_t size, int peek) {
+    int ret = nl_socket_set_msg_buf_size(nl->sock, size);
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (peek) {
+        nl_socket_enable_msg_peek(nl->sock);
+    } else {
+        nl_socket_disable_msg_peek(nl->sock);
+    }
+
+    return 0;
+}
+
+/**
+ * Waits until the socket has data to read.
+ *
+ * !Note Doesn't touch any python object, so it may be called without holding the GIL.
+ *
+ * @param nl netlink object.
+ * @param timeout timeout in milliseconds, negative to wait forever.
+ * @return positive if readable, zero on timeout, negative errno upon failure.
+ */
+int wait_nl(struct netlink *nl, int timeout) {
+    struct pollfd pfd = {
+        .fd = nl_socket_get_fd(nl->sock),
+        .events = POLLIN,
+    };
+
+    int ret = poll(&pfd, 1, timeout);
+
+    if (ret < 0) {
+        return -errno;
+    }
+
+    return ret;
+}
+
+/**
+ * Reads a single datagram from the socket, without running any callback.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf will point to a newly allocated buffer holding the datagram, the caller must free it.
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure
+ *         (-NLE_NOMEM if the receive buffer overran, -NLE_RECV_NOMEM if out of memory).
+ */
+int recv_raw_nl(struct netlink *nl, unsigned char **buf) {
+    struct sockaddr_nl nla;
+    int ret;
+
+    *buf = NULL;
+    ret = nl_recv(nl->sock, &nla, buf, NULL);
+
+    if (ret == -NLE_AGAIN) {
+        return 0;
+    }
+
+    // libnl translates ENOBUFS to -NLE_NOMEM, and fails its own allocations with it as well.
+    if (ret == -NLE_NOMEM) {
+        if (errno != ENOBUFS) {
+            return -NLE_RECV_NOMEM;
+        }
+
+        nl->overruns++;
+    }
+
+    return ret;
+}
+
+/**
+ * recv on the socket, translating the errors to libnl error codes.
+ * An overrun is counted in nl->overruns.
+ *
+ * @return number of bytes (the full datagram's size with MSG_TRUNC), zero if there is nothing to read, negative error code upon failure.
+ */
+static int recv_flags_nl(struct netlink *nl, void *buf, int len, int flags) {
+    ssize_t ret;
+
+    do {
+        ret = recv(nl_socket_get_fd(nl->sock), buf, len, flags);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+
+        if (errno == ENOBUFS) {
+            nl->overruns++;
+            return -NLE_NOMEM;
+        }
+
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return ret > INT_MAX ? INT_MAX : (int) ret;
+}
+
+/**
+ * Gets the size of the next datagram without reading it.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @return size of the datagram, zero if there is nothing to read, negative error code upon failure.
+ */
+int peek_size_nl(struct netlink *nl) {
+    return recv_flags_nl(nl, NULL, 0, MSG_PEEK | MSG_TRUNC);
+}
+
+/**
+ * Reads a single datagram into a caller's buffer, without running any callback.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf the buffer.
+ * @param len size of the buffer, a longer datagram is truncated (see peek_size_nl).
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure.
+ */
+int recv_into_nl(struct netlink *nl, void *buf, int len) {
+    return recv_flags_nl(nl, buf, len, 0);
+}
+
+/**
+ * Reads a single datagram with the multicast group it was sent to, without running any callback.
+ * Groups above 32 are only known once set_pktinfo_nl is enabled.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf will point to a newly allocated buffer holding the datagram, the caller must free it.
+ * @param group set to the multicast group, zero for a unicast datagram.
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure.
+ */
+int recv_datagram_nl(struct netlink *nl, unsigned char **buf, unsigned int *group) {
+    struct sockaddr_nl nla = {0};
+    char control[CMSG_SPACE(sizeof(struct nl_pktinfo))];
+    struct iovec iov;
+    struct msghdr msg = {
+        .msg_name = &nla,
+        .msg_namelen = sizeof(nla),
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control,
+        .msg_controllen = sizeof(control),
+    };
+    ssize_t ret;
+
+    *buf = NULL;
+    *group = 0;
+
+    int size = peek_size_nl(nl);
+
+    if (size <= 0) {
+        return size;
+    }
+
+    *buf = malloc(size);
+
+    if (*buf == NULL) {
+        return -NLE_NOMEM;
+    }
+
+    iov.iov_base = *buf;
+    iov.iov_len = size;
+
+    do {
+        ret = recvmsg(nl_socket_get_fd(nl->sock), &msg, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret <= 0) {
+        free(*buf);
+        *buf = NULL;
+
+        if (ret == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+
+        if (errno == ENOBUFS) {
+            nl->overruns++;
+            return -NLE_NOMEM;
+        }
+
+        return -nl_syserr2nlerr(errno);
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_NETLINK && cmsg->cmsg_type == NETLINK_PKTINFO) {
+            *group = ((struct nl_pktinfo *) CMSG_DATA(cmsg))->group;
+        }
+    }
+
+    // without NETLINK_PKTINFO only the mask of the first 32 groups is known.
+    if (*group == 0 && nla.nl_groups != 0) {
+        *group = ffs(nla.nl_groups);
+    }
+
+    return ret > INT_MAX ? INT_MAX : (int) ret;
+}
+
+/**
+ * Sets whether the kernel reports the multicast group of every datagram (NETLINK_PKTINFO).
+ *
+ * @param nl netlink object.
+ * @param enable non zero to report the groups.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_pktinfo_nl(struct netlink *nl, int enable) {
+    enable = !!enable;
+
+    if (setsockopt(nl_socket_get_fd(nl->sock), SOL_NETLINK, NETLINK_PKTINFO, &enable, sizeof(enable)) < 0) {
+        return -nl_syserr2nlerr(errno);
+    }
+
+    return 0;
+}
+
+/**
+ * Walks over the messages of a raw datagram.
+ *
+ * @param buf the datagram.
+ * @param len length of the datagram.
+ * @param callback called for each message, a non zero return value stops the walk.
+ * @param arg argument to pass to the callback.
+ * @return number of messages walked, negative if the callback stopped the walk.
+ */
+int foreach_msg_nl(unsigned char *buf, int len, int (*callback)(struct nlmsghdr *, void *), void *arg) {
+    struct nlmsghdr *hdr = (struct nlmsghdr *) buf;
+    int count = 0;
+
+    while (nlmsg_ok(hdr, len)) {
+        if (callback(hdr, arg) != 0) {
+            return -1;
+        }
+
+        count++;
+        hdr = nlmsg_next(hdr, &len);
+    }
+
+    return count;
+}
+
 /**
  * Closes netlink connection and frees the socket.
  *
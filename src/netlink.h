@@ -20,6 +20,7 @@
 #define NETLINK_H
 
 #include "attribute_policy.h"
+#include "genl_cache.h"
 #include <netlink/netlink.h>
 #include <netlink/genl/genl.h>
 #include <netlink/msg.h>
@@ -34,9 +35,21 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <poll.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <strings.h>
+#include <linux/filter.h>
 
 #define MAX_PAYLOAD 8692
 
+// callback kind (beside libnl's) that gets the messages of every recv at once, as a list of views.
+#define CB_KIND_BATCH (NL_CB_KIND_MAX + 1)
+
+// error code (beside libnl's) of a receive that couldn't allocate its buffer, libnl reports it as -NLE_NOMEM like an overrun.
+#define NLE_RECV_NOMEM (NLE_MAX + 1)
+
 /**
  * Represents a connection to a netlink family.
  *
@@ -46,6 +59,7 @@
  * protocol -> The protocol to use.
  * policies_len -> The number of attributes.
  * policies -> An array of the attribute's policies.
+ * overruns -> Number of times the receive buffer overran (ENOBUFS), every overrun lost messages.
  */
 struct netlink {
     struct nl_sock *sock;
@@ -54,6 +68,7 @@ struct netlink {
     int protocol;
     int policies_len;
     struct nla_policy *policies;
+    unsigned long overruns;
 };
 
 /**
@@ -71,6 +86,7 @@ struct netlink * initialize_netlink(struct netlink *nl, int protocol, int family
  * Resolves a family id from the family_name.
  * 
  * !Note Only for generic netlink ofcourse.
+ * The id comes from the process wide families cache (see genl_cache.h).
  *
  * @param family_name The family name to resolve.
  * @returns the family id.
@@ -98,22 +114,232 @@ int resolve_genl_group_id(char* family_name, char* group_name);
  */
 int send_nl(struct netlink *nl, struct nl_msg * msg);
 
+/**
+ * Which messages of a batch request an ack.
+ *
+ * BATCH_ACK_AUTO -> Left to the socket (libnl's auto ack).
+ * BATCH_ACK_ALL -> Every message.
+ * BATCH_ACK_LAST -> Only the last message, the kernel handles a batch in order so its ack acks them all.
+ */
+enum batch_ack {
+    BATCH_ACK_AUTO,
+    BATCH_ACK_ALL,
+    BATCH_ACK_LAST,
+};
+
+/**
+ * Sends many messages with as few sendmsg calls as possible.
+ * Every message is completed first (port, sequence number and flags), so the sequence numbers
+ * are assigned in one go, then the messages are packed into iovecs up to the socket's send buffer and IOV_MAX.
+ *
+ * !Note Doesn't touch any python object, so it may be called without holding the GIL.
+ *
+ * @param nl netlink object.
+ * @param msgs messages to send.
+ * @param count number of messages.
+ * @param ack which messages request an ack (batch_ack).
+ * @param seqs filled with the sequence number of every message.
+ * @return number of sendmsg calls, negative error code upon failure.
+ */
+int send_batch_nl(struct netlink *nl, struct nl_msg **msgs, int count, enum batch_ack ack, unsigned int *seqs);
+
+/**
+ * Returns the current time in milliseconds (monotonic).
+ */
+long long monotonic_ms(void);
+
 /**
  * Recieves a message.
+ * An overrun is counted in nl->overruns.
  *
  * @param nl netlink object
- * @return return code, zero upon success.
+ * @return return code, zero upon success, -NLE_NOMEM if the receive buffer overran, -NLE_RECV_NOMEM if out of memory.
  */
 int recv_nl(struct netlink *nl);
 
+/**
+ * Sets the socket's receive buffer size (SO_RCVBUF).
+ *
+ * @param nl netlink object.
+ * @param size requested size in bytes, the kernel doubles it for its bookkeeping.
+ * @param force use SO_RCVBUFFORCE to go over net.core.rmem_max (needs CAP_NET_ADMIN).
+ * @return the effective size, negative error code upon failure.
+ */
+int set_rcvbuf_nl(struct netlink *nl, int size, int force);
+
+/**
+ * Gets the socket's receive buffer size (SO_RCVBUF).
+ *
+ * @param nl netlink object.
+ * @return the size in bytes, negative error code upon failure.
+ */
+int get_rcvbuf_nl(struct netlink *nl);
+
+/**
+ * Enables or disables NETLINK_NO_ENOBUFS.
+ * When enabled the kernel doesn't report overruns caused by multicast deliveries, the messages are still lost.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_no_enobufs_nl(struct netlink *nl, int enable);
+
+/**
+ * Enables or disables NETLINK_CAP_ACK.
+ * When enabled the acks echo only the header of the request instead of the whole request.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_cap_ack_nl(struct netlink *nl, int enable);
+
+/**
+ * Enables or disables NETLINK_EXT_ACK.
+ * When enabled the errors carry attributes describing them (error message, offset of the invalid attribute...).
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_ext_ack_nl(struct netlink *nl, int enable);
+
+/**
+ * Enables or disables NETLINK_GET_STRICT_CHK.
+ * When enabled the kernel validates the headers of the dump requests strictly and applies their filters itself.
+ *
+ * @param nl netlink object.
+ * @param enable non zero to enable.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_strict_check_nl(struct netlink *nl, int enable);
+
+/**
+ * Attaches a classic BPF program to the socket (SO_ATTACH_FILTER), replacing the current one.
+ * The kernel runs it on every datagram before queueing it, the dropped datagrams are never copied to userspace.
+ *
+ * @param nl netlink object.
+ * @param code the program.
+ * @param len number of instructions.
+ * @return zero upon success, negative error code upon failure.
+ */
+int attach_filter_nl(struct netlink *nl, struct sock_filter *code, int len);
+
+/**
+ * Detaches the socket's BPF program (SO_DETACH_FILTER).
+ *
+ * @param nl netlink object.
+ * @return zero upon success, negative error code upon failure (-NLE_OBJ_NOTFOUND if there is none).
+ */
+int detach_filter_nl(struct netlink *nl);
+
+/**
+ * Sets the size of the buffer libnl receives into, and whether it peeks at the datagram size first.
+ * Without peeking a datagram bigger than the buffer is truncated.
+ *
+ * @param nl netlink object.
+ * @param size buffer size in bytes, zero for the page size.
+ * @param peek non zero to peek (MSG_PEEK) before every read.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_recv_buffer_nl(struct netlink *nl, size_t size, int peek);
+
+/**
+ * Waits until the socket has data to read.
+ *
+ * !Note Doesn't touch any python object, so it may be called without holding the GIL.
+ *
+ * @param nl netlink object.
+ * @param timeout timeout in milliseconds, negative to wait forever.
+ * @return positive if readable, zero on timeout, negative errno upon failure.
+ */
+int wait_nl(struct netlink *nl, int timeout);
+
+/**
+ * Statistics of a batched receive.
+ *
+ * reads -> Number of reads that returned data.
+ * bytes -> Total number of bytes read.
+ * messages -> Number of messages parsed out of the reads.
+ */
+struct recv_stats {
+    int reads;
+    long bytes;
+    int messages;
+};
+
+/**
+ * Reads a single datagram from the socket, without running any callback.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf will point to a newly allocated buffer holding the datagram, the caller must free it.
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure
+ *         (-NLE_NOMEM if the receive buffer overran, -NLE_RECV_NOMEM if out of memory).
+ */
+int recv_raw_nl(struct netlink *nl, unsigned char **buf);
+
+/**
+ * Gets the size of the next datagram without reading it.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @return size of the datagram, zero if there is nothing to read, negative error code upon failure.
+ */
+int peek_size_nl(struct netlink *nl);
+
+/**
+ * Reads a single datagram into a caller's buffer, without running any callback.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf the buffer.
+ * @param len size of the buffer, a longer datagram is truncated (see peek_size_nl).
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure.
+ */
+int recv_into_nl(struct netlink *nl, void *buf, int len);
+
+/**
+ * Reads a single datagram with the multicast group it was sent to, without running any callback.
+ * Groups above 32 are only known once set_pktinfo_nl is enabled.
+ * An overrun is counted in nl->overruns.
+ *
+ * @param nl netlink object.
+ * @param buf will point to a newly allocated buffer holding the datagram, the caller must free it.
+ * @param group set to the multicast group, zero for a unicast datagram.
+ * @return number of bytes read, zero if there is nothing to read, negative error code upon failure.
+ */
+int recv_datagram_nl(struct netlink *nl, unsigned char **buf, unsigned int *group);
+
+/**
+ * Sets whether the kernel reports the multicast group of every datagram (NETLINK_PKTINFO).
+ *
+ * @param nl netlink object.
+ * @param enable non zero to report the groups.
+ * @return zero upon success, negative error code upon failure.
+ */
+int set_pktinfo_nl(struct netlink *nl, int enable);
+
+/**
+ * Walks over the messages of a raw datagram.
+ *
+ * @param buf the datagram.
+ * @param len length of the datagram.
+ * @param callback called for each message, a non zero return value stops the walk.
+ * @param arg argument to pass to the callback.
+ * @return number of messages walked, negative if the callback stopped the walk.
+ */
+int foreach_msg_nl(unsigned char *buf, int len, int (*callback)(struct nlmsghdr *, void *), void *arg);
+
 /**
  * Parses attributes from a message.
  *
  * @param nl netlink object.
- * @param msg message to parse.
+ * @param nlh message to parse.
  * @param attrs attributes array in length of 1+MAX_ATTRIBUTE, the parsed attributes will be put there.
  */
-void parse_attr_nl(struct netlink *nl, struct nl_msg *msg, struct nlattr ** attrs);
+void parse_attr_nl(struct netlink *nl, struct nlmsghdr *nlh, struct nlattr ** attrs);
 
 /**
  * Modifies callbacks.
@@ -123,8 +349,9 @@ void parse_attr_nl(struct netlink *nl, struct nl_msg *msg, struct nlattr ** attr
  * @param type callback's type.
  * @param kind callback's kind.
  * @param arg arguments to add when calling the callback.
+ * @return zero upon success, negative error code upon failure.
  */
-void modify_cb(struct netlink *nl, enum nl_cb_type type, enum nl_cb_kind kind, void *callback, void * arg);
+int modify_cb(struct netlink *nl, enum nl_cb_type type, enum nl_cb_kind kind, void *callback, void * arg);
 
 /**
  * Adds a new memebership to a multicast group.
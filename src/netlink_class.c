@@ -19,8 +19,97 @@
 #include "netlink_class.h"
 #include "message.h"
 #include "attribute.h"
+#include "attribute_table.h"
+#include "dump.h"
 #include "attribute_policy.h"
+#include "filter.h"
+#include "ack.h"
 #include <Python.h>
+#include <errno.h>
+
+/**
+ * Checks that the netlink is still connected.
+ *
+ * @param self The netlink.
+ * @return zero if connected, -1 with an exception set otherwise.
+ */
+int netlink_ensure_open(NetLink *self) {
+	if (self->netlink == NULL || self->netlink->sock == NULL) {
+		PyErr_SetString(PyExc_ValueError, "I/O operation on a closed netlink.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Reports a receive buffer overrun (the overrun is already counted by the C layer),
+ * by calling the callback installed by set_overrun_callback.
+ *
+ * @param self The netlink.
+ * @return zero upon success, -1 with an exception set if the callback raised.
+ */
+int netlink_overrun(NetLink *self) {
+	if (self->overrun_callback == NULL) {
+		return 0;
+	}
+
+	// the callback may replace itself.
+	PyObject *callback = self->overrun_callback;
+	Py_INCREF(callback);
+	PyObject *result = PyObject_CallFunctionObjArgs(callback, (PyObject *) self, NULL);
+	Py_DECREF(callback);
+
+	if (result == NULL) {
+		return -1;
+	}
+
+	Py_DECREF(result);
+
+	return 0;
+}
+
+/**
+ * Waits with the GIL released until the socket is readable.
+ * Signals are checked whenever the wait is interrupted.
+ *
+ * @param self The netlink.
+ * @param timeout Timeout in seconds, zero to not wait at all and negative to wait forever.
+ * @return 1 if readable, 0 on timeout, -1 with an exception set upon failure.
+ */
+int netlink_wait_readable(NetLink *self, double timeout) {
+	int timeout_ms = timeout < 0 ? -1 : timeout * 1000 >= INT_MAX ? INT_MAX : (int) (timeout * 1000);
+	int ret;
+
+	if (self->receiver != NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "The socket is read by the receiver, use get_batch.");
+		return -1;
+	}
+
+	if (timeout == 0) {
+		return 1;
+	}
+
+	do {
+		self->io_count++;
+		Py_BEGIN_ALLOW_THREADS
+		ret = wait_nl(self->netlink, timeout_ms);
+		Py_END_ALLOW_THREADS
+		self->io_count--;
+
+		if (ret == -EINTR && PyErr_CheckSignals() < 0) {
+			return -1;
+		}
+	} while (ret == -EINTR);
+
+	if (ret < 0) {
+		errno = -ret;
+		PyErr_SetFromErrno(PyExc_OSError);
+		return -1;
+	}
+
+	return ret > 0;
+}
 
 #define resolve_genl_family_id_docs "A static method that resolve the family id of an generic netlink.\n@param family_name The family name\n@return The family id"
 
@@ -31,7 +120,11 @@ static PyObject *netlink_resolve_genl_family_id(PyObject *cls, PyObject *args) {
 		return NULL;
 	}
 
-	int family_id = resolve_genl_family_id(family_name);
+	int family_id;
+
+	Py_BEGIN_ALLOW_THREADS
+	family_id = resolve_genl_family_id(family_name);
+	Py_END_ALLOW_THREADS
 
 	return PyLong_FromLong(family_id);
 }
@@ -46,118 +139,1665 @@ static PyObject *netlink_resolve_genl_group_id(PyObject *cls, PyObject *args) {
 		return NULL;
 	}
 
-	int group_id = resolve_genl_group_id(family_name, group_name);
+	int group_id;
+
+	Py_BEGIN_ALLOW_THREADS
+	group_id = resolve_genl_group_id(family_name, group_name);
+	Py_END_ALLOW_THREADS
+
+	return PyLong_FromLong(group_id);
+}
+
+#define genl_family_docs "A static method that describes a generic netlink family, from the process wide families cache.\n@param family_name The family name\n@return dict with the keys id, version, hdrsize, maxattr, ops (list of command ids) and groups (dict of group name to group id)\n@raise LookupError if the family doesn't exist"
+
+static PyObject *netlink_genl_family(PyObject *cls, PyObject *args) {
+	struct genl_cache_family family;
+	char *family_name;
+	int ret;
+
+	if (!PyArg_ParseTuple(args, "s", &family_name)) {
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	ret = genl_cache_family(family_name, &family);
+	Py_END_ALLOW_THREADS
+
+	if (ret == -NLE_OBJ_NOTFOUND) {
+		PyErr_Format(PyExc_LookupError, "No generic netlink family named %s", family_name);
+		return NULL;
+	} else if (ret < 0) {
+		PyErr_Format(PyExc_OSError, "Failed to resolve the family: %s", nl_geterror(ret));
+		return NULL;
+	}
+
+	PyObject *ops = PyList_New(family.ops_len);
+	PyObject *groups = PyDict_New();
+	PyObject *result = NULL;
+
+	if (ops == NULL || groups == NULL) {
+		goto out;
+	}
+
+	for (int i = 0; i < family.ops_len; i++) {
+		PyObject *op = PyLong_FromUnsignedLong(family.ops[i]);
+
+		if (op == NULL) {
+			goto out;
+		}
+
+		PyList_SET_ITEM(ops, i, op);
+	}
+
+	for (int i = 0; i < family.groups_len; i++) {
+		PyObject *id = PyLong_FromUnsignedLong(family.groups[i].id);
+
+		if (id == NULL || PyDict_SetItemString(groups, family.groups[i].name, id) < 0) {
+			Py_XDECREF(id);
+			goto out;
+		}
+
+		Py_DECREF(id);
+	}
+
+	result = Py_BuildValue("{s:i,s:i,s:i,s:i,s:O,s:O}", "id", family.id, "version", family.version,
+			"hdrsize", family.hdrsize, "maxattr", family.maxattr, "ops", ops, "groups", groups);
+
+out:
+	Py_XDECREF(ops);
+	Py_XDECREF(groups);
+	genl_cache_family_clear(&family);
+
+	return result;
+}
+
+#define genl_cache_invalidate_docs "A static method that drops the generic netlink families cache.\nThe cache follows the controller's notifications by itself, this is only needed to force a new dump."
+
+static PyObject *netlink_genl_cache_invalidate(PyObject *cls, PyObject *args) {
+	Py_BEGIN_ALLOW_THREADS
+	genl_cache_invalidate();
+	Py_END_ALLOW_THREADS
+
+	Py_RETURN_NONE;
+}
+
+#define send_docs "Sends a message.\nThe GIL is released while sending.\n@param message The message to send\n@return The sequence number of the message"
+
+static PyObject *netlink_send(NetLink *self, PyObject *args) {
+    Message *message;
+
+    if (!PyArg_ParseTuple(args, "O!", &MessageType, &(message))) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    // nl_send_auto completes the header (port, seq), a wrapped message is copied first.
+    struct nl_msg *msg = message_nl_msg(message);
+
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    int ret;
+
+    self->io_count++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = send_nl(self->netlink, msg);
+    Py_END_ALLOW_THREADS
+    self->io_count--;
+
+    // a CB_MSG_OUT callback raised.
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    if (ret < 0) {
+        PyErr_SetString(PyExc_OSError, "Failed to send netlink message");
+        return NULL;
+    }
+
+    return PyLong_FromUnsignedLong(nlmsg_hdr(msg)->nlmsg_seq);
+}
+
+/**
+ * Where received messages are collected.
+ *
+ * netlink -> The netlink the messages were received on (decides their type).
+ * messages -> The list to append to.
+ */
+struct message_sink {
+	NetLink *netlink;
+	PyObject *messages;
+};
+
+/**
+ * Wraps a raw message with a new Message object (of the netlink's message type) and appends it to a list.
+ *
+ * @param self The netlink.
+ * @param hdr The raw message.
+ * @param messages The list to append to.
+ * @return zero upon success.
+ */
+static int append_raw_message(NetLink *self, struct nlmsghdr *hdr, PyObject *messages) {
+	Message *message = message_from_hdr(hdr, self->message_type);
+
+	if (message == NULL) {
+		return -1;
+	}
+
+	int ret = PyList_Append(messages, (PyObject *) message);
+	Py_DECREF(message);
+
+	return ret;
+}
+
+/**
+ * foreach_msg_nl callback of append_raw_message.
+ *
+ * @param hdr The raw message.
+ * @param sink The message_sink.
+ * @return zero upon success.
+ */
+static int append_to_sink(struct nlmsghdr *hdr, void *sink) {
+	return append_raw_message(((struct message_sink *) sink)->netlink, hdr, ((struct message_sink *) sink)->messages);
+}
+
+/**
+ * Converts a python collection of messages to an array of nl_msg.
+ *
+ * @param messages The python collection.
+ * @param sequence Will hold a new reference to a fast sequence that keeps the messages alive.
+ * @param count Will hold the number of messages.
+ * @return A newly allocated array (the caller frees it), NULL with an exception set upon failure.
+ */
+static struct nl_msg **messages_to_array(PyObject *messages, PyObject **sequence, int *count) {
+    *sequence = PySequence_Fast(messages, "messages must be a sequence");
+
+    if (*sequence == NULL) {
+        return NULL;
+    }
+
+    *count = PySequence_Fast_GET_SIZE(*sequence);
+
+    struct nl_msg **msgs = malloc(sizeof(struct nl_msg *) * (*count > 0 ? *count : 1));
+
+    if (msgs == NULL) {
+        Py_CLEAR(*sequence);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (int i = 0; i < *count; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(*sequence, i);
+
+        if (!PyObject_TypeCheck(item, &MessageType)) {
+            free(msgs);
+            Py_CLEAR(*sequence);
+            PyErr_SetString(PyExc_TypeError, "messages must contain only Message");
+            return NULL;
+        }
+
+        msgs[i] = message_nl_msg((Message *) item);
+
+        if (msgs[i] == NULL) {
+            free(msgs);
+            Py_CLEAR(*sequence);
+            return NULL;
+        }
+    }
+
+    return msgs;
+}
+
+/**
+ * Hands a message that no request is waiting for to the callback installed by modify_cb.
+ *
+ * @param self The netlink.
+ * @param hdr The message.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int deliver_unsolicited(NetLink *self, struct nlmsghdr *hdr) {
+	PyObject *callback = self->callbacks[NL_CB_VALID];
+
+	if (callback == NULL) {
+		return 0;
+	}
+
+	Message *message = message_from_hdr(hdr, self->message_type);
+
+	if (message == NULL) {
+		return -1;
+	}
+
+	PyObject *result = PyObject_CallFunctionObjArgs(callback, message, NULL);
+	Py_DECREF(message);
+
+	if (result == NULL) {
+		return -1;
+	}
+
+	Py_DECREF(result);
+	return 0;
+}
+
+/**
+ * Routes a received message to the pending request it answers,
+ * messages no request is waiting for are passed to the callback installed by modify_cb.
+ *
+ * @param hdr The message.
+ * @param arg The netlink.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+int netlink_dispatch_message(struct nlmsghdr *hdr, void *arg) {
+	NetLink *self = (NetLink *) arg;
+	struct pending_request *request = pending_find(&self->pending, hdr->nlmsg_seq);
+
+	if (request == NULL || request->state != PENDING_WAITING) {
+		return deliver_unsolicited(self, hdr);
+	}
+
+	switch (hdr->nlmsg_type) {
+	case NLMSG_ERROR: {
+		struct nlmsgerr *err = nlmsg_data(hdr);
+
+		if (hdr->nlmsg_len < (__u32) nlmsg_size(sizeof(*err))) {
+			pending_complete(&self->pending, hdr->nlmsg_seq, -EBADMSG);
+			return 0;
+		}
+
+		// an extended ack tells why the request failed, it joins the replies.
+		if (err->error != 0 && (hdr->nlmsg_flags & NLM_F_ACK_TLVS)) {
+			if (request->data == NULL && (request->data = PyList_New(0)) == NULL) {
+				return -1;
+			}
+
+			Ack *ack = ack_from_hdr(hdr);
+
+			if (ack == NULL || PyList_Append(request->data, (PyObject *) ack) < 0) {
+				Py_XDECREF(ack);
+				return -1;
+			}
+
+			Py_DECREF(ack);
+		}
+
+		pending_complete(&self->pending, hdr->nlmsg_seq, err->error);
+
+		return 0;
+	}
+	case NLMSG_DONE:
+		// dumps are never acked, their end is their completion.
+		pending_complete(&self->pending, hdr->nlmsg_seq, 0);
+		return 0;
+	case NLMSG_NOOP:
+	case NLMSG_OVERRUN:
+		return 0;
+	}
+
+	if (request->data == NULL) {
+		request->data = PyList_New(0);
+
+		if (request->data == NULL) {
+			return -1;
+		}
+	}
+
+	return append_raw_message(self, hdr, request->data);
+}
+
+/**
+ * Receives everything the socket has, routes it to the pending requests and expires the late ones.
+ *
+ * @param self The netlink.
+ * @param timeout Seconds to wait for the first datagram, zero to not wait.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int process_pending(NetLink *self, double timeout) {
+	int ready = netlink_wait_readable(self, timeout);
+
+	while (ready > 0) {
+		unsigned char *buf;
+		int len;
+
+		self->io_count++;
+		Py_BEGIN_ALLOW_THREADS
+		len = recv_raw_nl(self->netlink, &buf);
+		Py_END_ALLOW_THREADS
+		self->io_count--;
+
+		if (len == -NLE_RECV_NOMEM) {
+			PyErr_NoMemory();
+			return -1;
+		}
+
+		if (len == -NLE_NOMEM) {
+			// an overrun drops answers, the requests they belong to will time out.
+			free(buf);
+
+			if (netlink_overrun(self) < 0) {
+				return -1;
+			}
+
+			break;
+		}
+
+		if (len <= 0) {
+			free(buf);
+
+			if (len < 0) {
+				PyErr_Format(PyExc_OSError, "Failed to receive netlink message: %s", nl_geterror(len));
+				return -1;
+			}
+
+			break;
+		}
+
+		int count = foreach_msg_nl(buf, len, netlink_dispatch_message, self);
+		free(buf);
+
+		if (count < 0) {
+			return -1;
+		}
+	}
+
+	if (ready < 0) {
+		return -1;
+	}
+
+	pending_expire(&self->pending, monotonic_ms());
+
+	return 0;
+}
+
+/**
+ * Sends messages and registers them as pending requests.
+ * When the window is full, waits for requests in flight to complete or time out first.
+ *
+ * @param self The netlink.
+ * @param msgs The messages.
+ * @param count Number of messages.
+ * @param ack Which messages of every sent chunk request an ack (batch_ack).
+ * @param timeout Seconds until the requests time out.
+ * @param seqs Filled with the sequence number of every message.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int submit_pending(NetLink *self, struct nl_msg **msgs, int count, enum batch_ack ack, double timeout, unsigned int *seqs) {
+	int sent = 0;
+
+	while (sent < count) {
+		int room = self->pending.window - self->pending.waiting;
+
+		if (room <= 0) {
+			if (process_pending(self, timeout) < 0) {
+				return -1;
+			}
+
+			continue;
+		}
+
+		int chunk = count - sent < room ? count - sent : room;
+		int ret;
+
+		for (int i = sent; i < sent + chunk; i++) {
+			// a message keeps its sequence number once sent, resending it must wait for its answer.
+			unsigned int seq = nlmsg_hdr(msgs[i])->nlmsg_seq;
+
+			if (seq != NL_AUTO_SEQ && pending_find(&self->pending, seq) != NULL) {
+				PyErr_Format(PyExc_RuntimeError, "Sequence number %u is already pending (a message sent again before its answer was collected)", seq);
+				return -1;
+			}
+		}
+
+		self->io_count++;
+		Py_BEGIN_ALLOW_THREADS
+		ret = send_batch_nl(self->netlink, msgs + sent, chunk, ack, seqs + sent);
+		Py_END_ALLOW_THREADS
+		self->io_count--;
+
+		if (ret < 0) {
+			PyErr_Format(PyExc_OSError, "Failed to send netlink batch: %s", nl_geterror(ret));
+			return -1;
+		}
+
+		long long request_deadline = timeout < 0 ? PENDING_NO_DEADLINE : monotonic_ms() + (long long) (timeout * 1000);
+
+		for (int i = sent; i < sent + chunk; i++) {
+			unsigned int ack_seq = ack == BATCH_ACK_LAST ? seqs[sent + chunk - 1] : seqs[i];
+
+			// the rest of a dump is only queued on later reads, after the carrier's ack; its own NLMSG_DONE completes it.
+			if (nlmsg_hdr(msgs[i])->nlmsg_flags & NLM_F_DUMP) {
+				ack_seq = seqs[i];
+			}
+
+			if (pending_add(&self->pending, seqs[i], ack_seq, request_deadline) == NULL) {
+				if (pending_find(&self->pending, seqs[i]) != NULL) {
+					// the same message twice in the call, or the sequence numbers wrapped onto an uncollected request.
+					PyErr_Format(PyExc_RuntimeError, "Sequence number %u is already pending (a message sent twice, or a request whose completion wasn't collected)", seqs[i]);
+				} else {
+					PyErr_NoMemory();
+				}
+
+				// the requests of this call are forgotten, their answers are handled as unsolicited messages.
+				for (int j = 0; j < i; j++) {
+					Py_XDECREF((PyObject *) pending_remove(&self->pending, seqs[j]));
+				}
+
+				return -1;
+			}
+		}
+
+		sent += chunk;
+	}
+
+	return 0;
+}
+
+/**
+ * Waits until every given request completes (or times out).
+ *
+ * @param self The netlink.
+ * @param seqs The requests.
+ * @param count Number of requests.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int wait_pending(NetLink *self, unsigned int *seqs, int count) {
+	for (int i = 0; i < count;) {
+		struct pending_request *request = pending_find(&self->pending, seqs[i]);
+
+		if (request == NULL || request->state == PENDING_DONE) {
+			i++;
+			continue;
+		}
+
+		double remaining = -1;
+
+		if (request->deadline != PENDING_NO_DEADLINE) {
+			long long left = request->deadline - monotonic_ms();
+
+			remaining = left > 0 ? left / 1000.0 : 0;
+		}
+
+		if (process_pending(self, remaining) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Removes a completed request from the table.
+ *
+ * @param self The netlink.
+ * @param seq The request.
+ * @param with_seq Whether to put the sequence number in the result.
+ * @return A new tuple of [seq, error, replies] or [error, replies], NULL with an exception set upon failure.
+ */
+static PyObject *collect_pending(NetLink *self, unsigned int seq, int with_seq) {
+	struct pending_request *request = pending_find(&self->pending, seq);
+	int error = request != NULL ? request->error : -ENOENT;
+	PyObject *replies = pending_remove(&self->pending, seq);
+
+	if (replies == NULL) {
+		replies = PyList_New(0);
+
+		if (replies == NULL) {
+			return NULL;
+		}
+	}
+
+	if (with_seq) {
+		return Py_BuildValue("(kiN)", (unsigned long) seq, error, replies);
+	}
+
+	return Py_BuildValue("(iN)", error, replies);
+}
+
+#define send_batch_docs "Sends many messages with as few syscalls as possible (the socket's send buffer is the limit of each one).\nThe GIL is released while sending and waiting.\n@param messages The messages to send (list[Message])\n@param ack Request an ack for every message and wait for the outcomes, the window of pending requests (set_window) applies (default False)\n@param timeout Seconds to wait for the outcomes, negative to wait forever (default 1)\n@return list of the sequence numbers, or with ack list of tuples of [seq, error] where error is zero for an ack or a negative errno (-ETIMEDOUT if nothing arrived in time)"
+
+static PyObject *netlink_send_batch(NetLink *self, PyObject *args) {
+    PyObject *messages;
+    PyObject *sequence;
+    int ack = 0;
+    double timeout = 1;
+    int count;
+    PyObject *result = NULL;
+
+    if (!PyArg_ParseTuple(args, "O|pd", &messages, &ack, &timeout)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    struct nl_msg **msgs = messages_to_array(messages, &sequence, &count);
+
+    if (msgs == NULL) {
+        return NULL;
+    }
+
+    unsigned int *seqs = malloc(sizeof(unsigned int) * (count > 0 ? count : 1));
+
+    if (seqs == NULL) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    if (!ack) {
+        int ret;
+
+        self->io_count++;
+        Py_BEGIN_ALLOW_THREADS
+        ret = count > 0 ? send_batch_nl(self->netlink, msgs, count, BATCH_ACK_AUTO, seqs) : 0;
+        Py_END_ALLOW_THREADS
+        self->io_count--;
+
+        if (ret < 0) {
+            PyErr_Format(PyExc_OSError, "Failed to send netlink batch: %s", nl_geterror(ret));
+            goto out;
+        }
+    } else if (submit_pending(self, msgs, count, BATCH_ACK_ALL, timeout, seqs) < 0 || wait_pending(self, seqs, count) < 0) {
+        goto out;
+    }
+
+    result = PyList_New(count);
+
+    if (result == NULL) {
+        goto out;
+    }
+
+    for (int i = 0; i < count; i++) {
+        PyObject *item;
+
+        if (!ack) {
+            item = PyLong_FromUnsignedLong(seqs[i]);
+        } else {
+            // replies are dropped, pipeline() returns them.
+            struct pending_request *request = pending_find(&self->pending, seqs[i]);
+            int error = request != NULL ? request->error : -ENOENT;
+
+            Py_XDECREF((PyObject *) pending_remove(&self->pending, seqs[i]));
+            item = Py_BuildValue("(ki)", (unsigned long) seqs[i], error);
+        }
+
+        if (item == NULL) {
+            Py_CLEAR(result);
+            goto out;
+        }
+
+        PyList_SET_ITEM(result, i, item);
+    }
+
+out:
+    free(msgs);
+    free(seqs);
+    Py_DECREF(sequence);
+
+    return result;
+}
+
+#define pipeline_docs "Sends requests back to back and waits for all of them, without a round trip per request.\nOnly the last message of every window requests an ack, the kernel handles them in order so that ack completes all of them but the dumps, which complete at their NLMSG_DONE (errors are reported per request anyway).\n@param messages The requests (list[Message])\n@param timeout Seconds until the requests time out, negative to wait forever (default 1)\n@return list of tuples of [error, replies] in the order of the requests, error is zero upon success or a negative errno (-ETIMEDOUT if the request timed out)"
+
+static PyObject *netlink_pipeline(NetLink *self, PyObject *args) {
+    PyObject *messages;
+    PyObject *sequence;
+    double timeout = 1;
+    int count;
+    PyObject *result = NULL;
+
+    if (!PyArg_ParseTuple(args, "O|d", &messages, &timeout)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    struct nl_msg **msgs = messages_to_array(messages, &sequence, &count);
+
+    if (msgs == NULL) {
+        return NULL;
+    }
+
+    unsigned int *seqs = malloc(sizeof(unsigned int) * (count > 0 ? count : 1));
+
+    if (seqs == NULL) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    if (submit_pending(self, msgs, count, BATCH_ACK_LAST, timeout, seqs) < 0 || wait_pending(self, seqs, count) < 0) {
+        goto out;
+    }
+
+    result = PyList_New(count);
+
+    if (result == NULL) {
+        goto out;
+    }
+
+    for (int i = 0; i < count; i++) {
+        PyObject *item = collect_pending(self, seqs[i], 0);
+
+        if (item == NULL) {
+            Py_CLEAR(result);
+            goto out;
+        }
+
+        PyList_SET_ITEM(result, i, item);
+    }
+
+out:
+    free(msgs);
+    free(seqs);
+    Py_DECREF(sequence);
+
+    return result;
+}
+
+#define submit_docs "Sends requests back to back without waiting for them, collect them later with completions().\nOnly the last message of every window requests an ack, the kernel handles them in order so that ack completes all of them but the dumps, which complete at their NLMSG_DONE.\n@param messages The requests (list[Message])\n@param timeout Seconds until the requests time out (default 1)\n@return list of the sequence numbers of the requests"
+
+static PyObject *netlink_submit(NetLink *self, PyObject *args) {
+    PyObject *messages;
+    PyObject *sequence;
+    double timeout = 1;
+    int count;
+    PyObject *result = NULL;
+
+    if (!PyArg_ParseTuple(args, "O|d", &messages, &timeout)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    struct nl_msg **msgs = messages_to_array(messages, &sequence, &count);
+
+    if (msgs == NULL) {
+        return NULL;
+    }
+
+    unsigned int *seqs = malloc(sizeof(unsigned int) * (count > 0 ? count : 1));
+
+    if (seqs == NULL) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    if (submit_pending(self, msgs, count, BATCH_ACK_LAST, timeout, seqs) < 0) {
+        goto out;
+    }
+
+    result = PyList_New(count);
+
+    for (int i = 0; result != NULL && i < count; i++) {
+        PyObject *seq = PyLong_FromUnsignedLong(seqs[i]);
+
+        if (seq == NULL) {
+            Py_CLEAR(result);
+            break;
+        }
+
+        PyList_SET_ITEM(result, i, seq);
+    }
+
+out:
+    free(msgs);
+    free(seqs);
+    Py_DECREF(sequence);
+
+    return result;
+}
+
+#define completions_docs "Collects the submitted requests that completed (or timed out).\nMessages that don't answer any request are passed to the callback installed by modify_cb.\n@param timeout Seconds to wait when nothing completed yet, zero to not wait (default)\n@return list of tuples of [seq, error, replies], error is zero upon success or a negative errno (-ETIMEDOUT if the request timed out)"
+
+static PyObject *netlink_completions(NetLink *self, PyObject *args) {
+    double timeout = 0;
+    int done = 0;
+
+    if (!PyArg_ParseTuple(args, "|d", &timeout)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    for (int i = 0; i < self->pending.capacity; i++) {
+        done += self->pending.slots[i].state == PENDING_DONE;
+    }
+
+    if (process_pending(self, done || self->pending.count == 0 ? 0 : timeout) < 0) {
+        return NULL;
+    }
+
+    int count = 0;
+    unsigned int *seqs = malloc(sizeof(unsigned int) * self->pending.capacity);
+
+    if (seqs == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    // collected in two passes, removing a request moves the others.
+    for (int i = 0; i < self->pending.capacity; i++) {
+        if (self->pending.slots[i].state == PENDING_DONE) {
+            seqs[count++] = self->pending.slots[i].seq;
+        }
+    }
+
+    PyObject *result = PyList_New(count);
+
+    for (int i = 0; result != NULL && i < count; i++) {
+        PyObject *item = collect_pending(self, seqs[i], 1);
+
+        if (item == NULL) {
+            Py_CLEAR(result);
+            break;
+        }
+
+        PyList_SET_ITEM(result, i, item);
+    }
+
+    free(seqs);
+
+    return result;
+}
+
+#define set_window_docs "Sets the maximum number of requests in flight (pipeline, submit and send_batch with ack).\nThe answers of a whole window must fit in the socket's receive buffer, answers lost to an overrun make their requests time out.\nCan't be changed while there are pending requests.\n@param window The window size"
+
+static PyObject *netlink_set_window(NetLink *self, PyObject *args) {
+    int window;
+
+    if (!PyArg_ParseTuple(args, "i", &window)) {
+        return NULL;
+    }
+
+    if (window <= 0) {
+        PyErr_SetString(PyExc_ValueError, "The window must be positive.");
+        return NULL;
+    }
+
+    if (self->pending.count > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Can't change the window while there are pending requests.");
+        return NULL;
+    }
+
+    pending_free(&self->pending);
+
+    if (pending_init(&self->pending, window) < 0) {
+        return PyErr_NoMemory();
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define dump_docs "Sends a dump request and iterates over its answer as it arrives.\nOnly one datagram is held at a time, NLM_F_DUMP is set on the request.\nAbandoning the iterator before it ends leaves the rest of the dump on the socket.\n@param message The request\n@param timeout Seconds to wait for every datagram, negative to wait forever and zero to raise TimeoutError when nothing is queued (default 1)\n@return iterator of the messages (DumpIterator), check its interrupted flag once it ends"
+
+static PyObject *netlink_dump(NetLink *self, PyObject *args) {
+    Message *message;
+    double timeout = 1;
+    int ret;
+
+    if (!PyArg_ParseTuple(args, "O!|d", &MessageType, &message, &timeout)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    struct nl_msg *msg = message_nl_msg(message);
+
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    nlmsg_hdr(msg)->nlmsg_flags |= NLM_F_DUMP;
+
+    self->io_count++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = send_nl(self->netlink, msg);
+    Py_END_ALLOW_THREADS
+    self->io_count--;
+
+    if (ret < 0) {
+        PyErr_SetString(PyExc_OSError, "Failed to send the dump request");
+        return NULL;
+    }
+
+    return (PyObject *) dump_iterator_new(self, nlmsg_hdr(msg)->nlmsg_seq, timeout);
+}
+
+#define parse_docs "Parses message's attributes.\nOnly the nlattr index is built, Attribute objects are created on first access.\n@param message message to parse\n@param view if true the attributes are views into the message's buffer instead of copies\n@param decode if true the attributes are decoded in C according to their policy types instead (see Attribute.decode)\n@return table of attributes indexed by type (AttributeTable), or a dict of type to native value when decoding."
+
+static PyObject *netlink_parse(NetLink *self, PyObject *args) {
+    Message *message;
+    int view = 0;
+    int decode = 0;
+
+    if (!PyArg_ParseTuple(args, "O!|pp", &MessageType, &(message), &view, &decode)) {
+        return NULL;
+    }
+
+    struct nlmsghdr *nlh = message_hdr(message);
+
+    if (nlh == NULL) {
+        PyErr_SetString(PyExc_ValueError, "The message has no buffer");
+        return NULL;
+    }
+
+    if (decode) {
+        struct nlattr **attrs = calloc(self->netlink->policies_len + 1, sizeof(struct nlattr *));
+
+        if (attrs == NULL) {
+            return PyErr_NoMemory();
+        }
+
+        parse_attr_nl(self->netlink, nlh, attrs);
+        PyObject *values = attributes_decode(attrs, self->policy_table);
+        free(attrs);
+
+        return values;
+    }
+
+    AttributeTable *table = attribute_table_new((PyObject *) message, self->policy_table, view);
+
+    if (table == NULL) {
+        return NULL;
+    }
+
+    parse_attr_nl(self->netlink, nlh, table->attrs);
+
+    return (PyObject *) table;
+}
+
+#define fileno_docs "@return The socket's file descriptor, for use with select/poll/asyncio.\nThe socket is non-blocking."
+
+static PyObject *netlink_fileno(NetLink *self, PyObject *args) {
+	if (netlink_ensure_open(self) < 0) {
+		return NULL;
+	}
+
+	return PyLong_FromLong(nl_socket_get_fd(self->netlink->sock));
+}
+
+#define get_family_id_docs "Getter for the family id.\n@return the family id"
+
+static PyObject *netlink_get_family_id(NetLink *self, PyObject *args) {
+	return PyLong_FromLong(self->netlink->family_id);
+}
+
+#define disable_seq_check_docs "Disables the sequential check."
+
+static PyObject *netlink_disable_seq(NetLink *self, PyObject *args) {
+	disable_seq_check(self->netlink);
+
+	Py_RETURN_NONE;
+}
+
+/**
+ * Callback handler.
+ * Used as a middle man between the cb and the python.
+ * The callback may return a CB_Action (None is CB_OK), if it raises the receive stops
+ * and the exception is raised by recv.
+ *
+ * @param msg The recieved msg.
+ * @param callback The callback to call.
+ * @return NL_OK, NL_SKIP or NL_STOP.
+ */
+static int cb_callback_handler(struct nl_msg *msg, PyObject *callback) {
+	PyGILState_STATE gstate;
+	gstate = PyGILState_Ensure();
+	int action = NL_OK;
+
+	// libnl frees msg after the callback returns, the Message gets its own copy.
+	Message *message = message_from_hdr(nlmsg_hdr(msg), &MessageType);
+	PyObject *result = NULL;
+
+	if (message != NULL) {
+		result = PyObject_CallFunctionObjArgs(callback, message, NULL);
+		Py_DECREF(message);
+	}
+
+	if (result == NULL) {
+		// the exception stays set, recv raises it.
+		action = NL_STOP;
+	} else if (PyLong_Check(result)) {
+		action = PyLong_AsLong(result);
+
+		if (action != NL_OK && action != NL_SKIP && action != NL_STOP) {
+			PyErr_Format(PyExc_ValueError, "The callback returned %d, which isn't a CB_Action", action);
+			action = NL_STOP;
+		}
+	}
+
+	Py_XDECREF(result);
+	PyGILState_Release(gstate);
+
+	return action;
+}
+
+/**
+ * Receives one datagram and hands all its messages to the batch callback in one call.
+ * The datagram is read straight into a bytes object, the messages are views into it
+ * that are invalidated once the callback returns.
+ *
+ * @param self The netlink.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int netlink_recv_batch(NetLink *self) {
+	int size;
+	int len;
+
+	self->io_count++;
+	Py_BEGIN_ALLOW_THREADS
+	size = peek_size_nl(self->netlink);
+	Py_END_ALLOW_THREADS
+	self->io_count--;
+
+	if (size == -NLE_NOMEM) {
+		return netlink_overrun(self);
+	}
+
+	if (size <= 0) {
+		if (size < 0) {
+			PyErr_Format(PyExc_OSError, "Failed to receive netlink message: %s", nl_geterror(size));
+		}
+
+		return size;
+	}
+
+	PyObject *datagram = PyBytes_FromStringAndSize(NULL, size);
+
+	if (datagram == NULL) {
+		return -1;
+	}
+
+	// nothing else references the bytes yet, it is filled without the GIL.
+	self->io_count++;
+	Py_BEGIN_ALLOW_THREADS
+	len = recv_into_nl(self->netlink, PyBytes_AS_STRING(datagram), size);
+	Py_END_ALLOW_THREADS
+	self->io_count--;
+
+	if (len <= 0) {
+		Py_DECREF(datagram);
+
+		if (len == -NLE_NOMEM) {
+			return netlink_overrun(self);
+		} else if (len < 0) {
+			PyErr_Format(PyExc_OSError, "Failed to receive netlink message: %s", nl_geterror(len));
+			return -1;
+		}
+
+		return 0;
+	}
+
+	PyObject *views = PyList_New(0);
+	struct nlmsghdr *hdr = (struct nlmsghdr *) PyBytes_AS_STRING(datagram);
+	PyObject *result = NULL;
+
+	while (views != NULL && nlmsg_ok(hdr, len)) {
+		Message *view = message_wrap(self->message_type, datagram, hdr);
+
+		if (view == NULL || PyList_Append(views, (PyObject *) view) < 0) {
+			Py_XDECREF(view);
+			Py_CLEAR(views);
+			break;
+		}
+
+		Py_DECREF(view);
+		hdr = nlmsg_next(hdr, &len);
+	}
+
+	if (views != NULL) {
+		result = PyObject_CallFunctionObjArgs(self->batch_callback, views, NULL);
+
+		// views the callback kept are no longer usable.
+		for (Py_ssize_t i = 0; i < PyList_GET_SIZE(views); i++) {
+			message_invalidate((Message *) PyList_GET_ITEM(views, i));
+		}
+
+		Py_DECREF(views);
+	}
+
+	Py_DECREF(datagram);
+
+	if (result == NULL) {
+		return -1;
+	}
+
+	Py_DECREF(result);
+
+	return 0;
+}
+
+#define modify_cb_docs "Modifies the cb of the netlink.\nEvery CB_Type is honoured: with CB_CUSTOM the callback gets a Message and may return a CB_Action (None is CB_OK),\nan exception it raises is raised by the recv (or send, for CB_MSG_OUT) that called it.\nThe other kinds install libnl's own handlers, their callback is ignored and may be None.\nWith the CB_BATCH kind (CB_VALID only) the callback gets the messages of every recv at once, as a list of views into\nthe received datagram. The views are invalidated once the callback returns (copy what should be kept, e.g. bytes(message)).\n@param kind kind of the object (CB_Kind).\n@param type type of the object (CB_Type)\n@param callback The callback to set"
+
+static PyObject *netlink_modify_cb(NetLink *self, PyObject *args) {
+    PyObject *callback;
+    int kind;
+    int type;
+    int ret;
+
+    if (!PyArg_ParseTuple(args, "iiO:modify_cb", &kind, &type, &callback)) {
+	   return NULL;
+    }
+
+    if (type < 0 || type > NL_CB_TYPE_MAX) {
+        PyErr_Format(PyExc_ValueError, "%d isn't a CB_Type", type);
+        return NULL;
+    }
+
+    if ((kind < 0 || kind > NL_CB_KIND_MAX) && kind != CB_KIND_BATCH) {
+        PyErr_Format(PyExc_ValueError, "%d isn't a CB_Kind", kind);
+        return NULL;
+    }
+
+    if ((kind == NL_CB_CUSTOM || kind == CB_KIND_BATCH) && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    if (kind == CB_KIND_BATCH) {
+        if (type != NL_CB_VALID) {
+            PyErr_SetString(PyExc_ValueError, "CB_BATCH is only supported with CB_VALID");
+            return NULL;
+        }
+
+        Py_INCREF(callback);
+        Py_XSETREF(self->batch_callback, callback);
+        Py_RETURN_NONE;
+    }
+
+    if (kind == NL_CB_CUSTOM) {
+        ret = modify_cb(self->netlink, type, kind, cb_callback_handler, callback);
+    } else {
+        ret = modify_cb(self->netlink, type, kind, NULL, NULL);
+    }
+
+    if (ret < 0) {
+        PyErr_Format(PyExc_OSError, "Failed to modify the cb: %s", nl_geterror(ret));
+        return NULL;
+    }
+
+    // libnl only keeps a borrowed pointer to the callback.
+    if (kind == NL_CB_CUSTOM) {
+        Py_INCREF(callback);
+        Py_XSETREF(self->callbacks[type], callback);
+    } else {
+        Py_CLEAR(self->callbacks[type]);
+    }
+
+    if (type == NL_CB_VALID) {
+        // the batch callback would take over recv.
+        Py_CLEAR(self->batch_callback);
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Releases a handler of the router.
+ *
+ * @param handler The handler, a python callable.
+ */
+static void release_handler(void *handler) {
+    Py_DECREF((PyObject *) handler);
+}
+
+/**
+ * The generic netlink family whose commands are routed by the router.
+ *
+ * @param self The netlink.
+ * @return The family id, -1 if the netlink isn't a generic netlink.
+ */
+static int routed_family(NetLink *self) {
+    if (self->netlink == NULL || self->netlink->protocol != NETLINK_GENERIC) {
+        return -1;
+    }
+
+    return self->netlink->family_id;
+}
+
+#define route_docs "Routes the messages read by dispatch to a handler, by generic netlink command, nlmsg_type or multicast group.\nThe routes are looked up in C, messages nobody handles are dropped without calling into python.\nA message goes to the first match of: its command (generic netlink messages of the netlink's family), its type,\nthe multicast group it arrived on and the default handler.\n@param handler Called with the Message, None removes the route\n@param type Route messages of this nlmsg_type\n@param cmd Route generic netlink messages of this command\n@param group Route messages of this multicast group\nWithout a selector the handler is the default handler"
+
+static PyObject *netlink_route(NetLink *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"handler", "type", "cmd", "group", NULL};
+    PyObject *handler;
+    int type = -1;
+    int cmd = -1;
+    int group = -1;
+    void *old = NULL;
+    int ret = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|iii:route", kwlist, &handler, &type, &cmd, &group)) {
+        return NULL;
+    }
+
+    if ((type >= 0) + (cmd >= 0) + (group >= 0) > 1) {
+        PyErr_SetString(PyExc_ValueError, "Only one of type, cmd and group may be given");
+        return NULL;
+    }
+
+    if (handler == Py_None) {
+        handler = NULL;
+    } else if (!PyCallable_Check(handler)) {
+        PyErr_SetString(PyExc_TypeError, "handler must be callable");
+        return NULL;
+    }
+
+    if (type > UINT16_MAX || cmd >= ROUTER_MAX_CMD || group == 0) {
+        PyErr_SetString(PyExc_ValueError, "The type, cmd or group is out of range");
+        return NULL;
+    }
+
+    if (cmd >= 0 && routed_family(self) < 0) {
+        PyErr_SetString(PyExc_ValueError, "Commands are only routed on a generic netlink");
+        return NULL;
+    }
+
+    if (group > 0 && handler != NULL && !self->pktinfo) {
+        if (netlink_ensure_open(self) < 0) {
+            return NULL;
+        }
+
+        // the source address only tells the first 32 groups apart.
+        ret = set_pktinfo_nl(self->netlink, 1);
+
+        if (ret < 0) {
+            PyErr_Format(PyExc_OSError, "Failed to enable NETLINK_PKTINFO: %s", nl_geterror(ret));
+            return NULL;
+        }
+
+        self->pktinfo = 1;
+    }
+
+    Py_XINCREF(handler);
+
+    if (type >= 0) {
+        ret = route_set(&self->router.types, type, handler, &old);
+    } else if (group > 0) {
+        ret = route_set(&self->router.groups, group, handler, &old);
+    } else if (cmd >= 0) {
+        old = self->router.by_cmd[cmd];
+        self->router.by_cmd[cmd] = handler;
+        self->router.cmds += (handler != NULL) - (old != NULL);
+    } else {
+        old = self->router.fallback;
+        self->router.fallback = handler;
+    }
+
+    if (ret < 0) {
+        Py_XDECREF(handler);
+        return PyErr_NoMemory();
+    }
+
+    Py_XDECREF((PyObject *) old);
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Where dispatch is routing the messages of a datagram.
+ *
+ * self -> The netlink.
+ * group -> The multicast group the datagram arrived on, zero if unicast.
+ * family -> The generic netlink family whose commands are routed, -1 if none.
+ * handled -> Number of messages handed to a handler.
+ */
+struct dispatch_context {
+    NetLink *self;
+    unsigned int group;
+    int family;
+    long handled;
+};
+
+/**
+ * foreach_msg_nl callback of dispatch, hands a message to its handler.
+ *
+ * @param hdr The message.
+ * @param arg The dispatch_context.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int route_message(struct nlmsghdr *hdr, void *arg) {
+    struct dispatch_context *context = (struct dispatch_context *) arg;
+    PyObject *handler = router_lookup(&context->self->router, hdr, context->group, context->family);
+
+    if (handler == NULL) {
+        return 0;
+    }
+
+    Message *message = message_from_hdr(hdr, context->self->message_type);
+
+    if (message == NULL) {
+        return -1;
+    }
+
+    // the handler may remove its own route.
+    Py_INCREF(handler);
+    PyObject *result = PyObject_CallFunctionObjArgs(handler, message, NULL);
+    Py_DECREF(handler);
+    Py_DECREF(message);
+
+    if (result == NULL) {
+        return -1;
+    }
+
+    Py_DECREF(result);
+    context->handled++;
+
+    return 0;
+}
+
+#define dispatch_docs "Receives datagrams and hands their messages to the handlers installed by route.\nThe GIL is released while waiting and reading, messages nobody handles are dropped without a python call.\nSubmitted requests aren't completed by dispatch (see completions), an exception a handler raises stops the dispatch\nand is raised, the rest of that datagram is dropped.\n@param timeout Seconds to wait for the first datagram, zero to not wait (default) and negative to wait forever\n@param max_msgs Stop after this many messages (checked between datagrams), zero for no limit (default 64)\n@return A tuple of [received, handled]"
+
+static PyObject *netlink_dispatch(NetLink *self, PyObject *args) {
+    double timeout = 0;
+    int max_msgs = 64;
+    long received = 0;
+    int reads = 0;
+    struct dispatch_context context = { self, 0, routed_family(self), 0 };
+
+    if (!PyArg_ParseTuple(args, "|di", &timeout, &max_msgs)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ready = netlink_wait_readable(self, timeout);
+
+    if (ready < 0) {
+	    return NULL;
+    }
+
+    while (ready && (max_msgs <= 0 || received < max_msgs)) {
+	    unsigned char *buf;
+	    int len;
+
+	    self->io_count++;
+	    Py_BEGIN_ALLOW_THREADS
+	    len = recv_datagram_nl(self->netlink, &buf, &context.group);
+	    Py_END_ALLOW_THREADS
+	    self->io_count--;
+
+	    if (len == -NLE_NOMEM) {
+		    if (netlink_overrun(self) < 0) {
+			    return NULL;
+		    }
+
+		    break;
+	    }
+
+	    if (len <= 0) {
+		    if (len < 0 && reads == 0) {
+			    PyErr_Format(PyExc_OSError, "Failed to receive netlink message: %s", nl_geterror(len));
+			    return NULL;
+		    }
+
+		    break;
+	    }
+
+	    int count = foreach_msg_nl(buf, len, route_message, &context);
+	    free(buf);
+
+	    if (count < 0) {
+		    return NULL;
+	    }
+
+	    reads++;
+	    received += count;
+    }
+
+    return Py_BuildValue("(ll)", received, context.handled);
+}
+
+#define set_rcvbuf_docs "Sets the socket's receive buffer size (SO_RCVBUF).\nA bigger buffer absorbs longer bursts of multicast events before overrunning.\n@param size Requested size in bytes, the kernel doubles it for its bookkeeping\n@param force Use SO_RCVBUFFORCE to go over net.core.rmem_max, needs CAP_NET_ADMIN (default False)\n@return The effective size in bytes"
+
+static PyObject *netlink_set_rcvbuf(NetLink *self, PyObject *args) {
+    int size;
+    int force = 0;
+
+    if (!PyArg_ParseTuple(args, "i|p", &size, &force)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ret = set_rcvbuf_nl(self->netlink, size, force);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set the receive buffer size: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    return PyLong_FromLong(ret);
+}
+
+#define get_rcvbuf_docs "Gets the socket's receive buffer size (SO_RCVBUF).\n@return The size in bytes"
+
+static PyObject *netlink_get_rcvbuf(NetLink *self, PyObject *args) {
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ret = get_rcvbuf_nl(self->netlink);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to get the receive buffer size: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    return PyLong_FromLong(ret);
+}
+
+#define set_recv_buffer_docs "Sets the size of the buffer datagrams are received into.\nWithout peeking a datagram bigger than the buffer is truncated, with peeking every read costs an extra syscall.\n@param size Buffer size in bytes, zero for the page size\n@param peek Peek at the datagram size before every read (default True)"
+
+static PyObject *netlink_set_recv_buffer(NetLink *self, PyObject *args) {
+    Py_ssize_t size;
+    int peek = 1;
+
+    if (!PyArg_ParseTuple(args, "n|p", &size, &peek)) {
+	    return NULL;
+    }
+
+    if (size < 0) {
+	    PyErr_SetString(PyExc_ValueError, "size must not be negative");
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ret = set_recv_buffer_nl(self->netlink, size, peek);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set the receive buffer: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define set_no_enobufs_docs "Enables or disables NETLINK_NO_ENOBUFS.\nWhen enabled the kernel stops reporting overruns caused by multicast events, the events are still lost but these overruns aren't counted anymore.\n@param enable True to enable"
+
+static PyObject *netlink_set_no_enobufs(NetLink *self, PyObject *args) {
+    int enable;
+
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ret = set_no_enobufs_nl(self->netlink, enable);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set NETLINK_NO_ENOBUFS: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Reads a filter rule from its dict.
+ *
+ * @param self The netlink.
+ * @param dict The rule, with any of the keys type, cmd, attr, offset, size and value.
+ * @param rule Set to the rule.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int parse_filter_rule(NetLink *self, PyObject *dict, struct filter_rule *rule) {
+    static const char *keys[] = {"type", "cmd", "attr", "offset", "size", "value"};
+    // the largest value of every key, checked before the fields are narrowed.
+    static const long limits[] = {UINT16_MAX, UINT8_MAX, (uint16_t) NLA_TYPE_MASK, UINT16_MAX, 4, UINT32_MAX};
+    long fields[6] = {-1, -1, -1, 0, 4, -1};
+    PyObject *key;
+    PyObject *value;
+    Py_ssize_t position = 0;
+
+    if (!PyDict_Check(dict)) {
+        PyErr_SetString(PyExc_TypeError, "A filter rule must be a dict");
+        return -1;
+    }
+
+    while (PyDict_Next(dict, &position, &key, &value)) {
+        const char *name = PyUnicode_Check(key) ? PyUnicode_AsUTF8(key) : NULL;
+        int i = 0;
+
+        while (name != NULL && i < 6 && strcmp(name, keys[i]) != 0) {
+            i++;
+        }
+
+        if (name == NULL || i == 6) {
+            PyErr_Format(PyExc_ValueError, "Unknown filter rule key %R", key);
+            return -1;
+        }
+
+        fields[i] = PyLong_AsLong(value);
+
+        if (fields[i] == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+
+        if (fields[i] < 0 || fields[i] > limits[i]) {
+            PyErr_Format(PyExc_ValueError, "The filter rule's %s is out of range (0 to %ld)", keys[i], limits[i]);
+            return -1;
+        }
+    }
+
+    if (fields[4] != 1 && fields[4] != 2 && fields[4] != 4) {
+        PyErr_SetString(PyExc_ValueError, "The filter rule's size must be 1, 2 or 4");
+        return -1;
+    }
+
+    *rule = (struct filter_rule) {
+        .type = fields[0],
+        .cmd = fields[1],
+        .attr = fields[2],
+        .offset = fields[3],
+        .size = fields[4],
+        .value = fields[5] < 0 ? 0 : (uint32_t) fields[5],
+        .has_value = fields[5] >= 0,
+    };
+
+    if (rule->cmd >= 0 && self->netlink->protocol != NETLINK_GENERIC) {
+        PyErr_SetString(PyExc_ValueError, "Commands are only filtered on a generic netlink");
+        return -1;
+    }
+
+    return 0;
+}
+
+#define attach_filter_docs "Attaches an in-kernel filter (a classic BPF program, SO_ATTACH_FILTER) replacing the current one.\nDropped messages are never copied to userspace. Control messages (acks, errors, NLMSG_DONE) always pass, and\nonly the first message of a datagram is checked (events come one per datagram, a dump reply passes or not as a whole).\nA message passes when it matches any rule, a rule is a dict whose conditions must all hold:\n  type: the nlmsg_type\n  cmd: the generic netlink command (generic netlink only)\n  attr: type of the attribute at offset\n  offset: offset of the attribute from the start of the attributes (default 0, the first attribute)\n  value: value of that attribute, compared as an unsigned integer of size bytes\n  size: 1, 2 or 4 (default 4)\n@param rules list of rules"
+
+static PyObject *netlink_attach_filter(NetLink *self, PyObject *args) {
+    PyObject *rules;
+    struct sock_filter *code;
+
+    if (!PyArg_ParseTuple(args, "O!", &PyList_Type, &rules)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    Py_ssize_t count = PyList_GET_SIZE(rules);
+
+    if (count == 0 || count > FILTER_MAX_RULES) {
+	    PyErr_Format(PyExc_ValueError, "A filter has between 1 and %d rules (detach_filter removes it)", FILTER_MAX_RULES);
+	    return NULL;
+    }
+
+    struct filter_rule *parsed = PyMem_Calloc(count, sizeof(struct filter_rule));
+
+    if (parsed == NULL) {
+	    return PyErr_NoMemory();
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++) {
+	    if (parse_filter_rule(self, PyList_GET_ITEM(rules, i), &parsed[i]) < 0) {
+		    PyMem_Free(parsed);
+		    return NULL;
+	    }
+    }
+
+    int len = filter_compile(parsed, count, NLMSG_HDRLEN + NLMSG_ALIGN(self->netlink->hdrlen), &code);
+    PyMem_Free(parsed);
+
+    if (len == -ENOMEM) {
+	    return PyErr_NoMemory();
+    } else if (len < 0) {
+	    PyErr_SetString(PyExc_ValueError, "Invalid filter rule (a value needs an attr and must fit its size, offsets are 4 bytes aligned)");
+	    return NULL;
+    }
+
+    int ret = attach_filter_nl(self->netlink, code, len);
+    free(code);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to attach the filter: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define detach_filter_docs "Detaches the in-kernel filter, every message passes again.\n@return True if a filter was attached"
+
+static PyObject *netlink_detach_filter(NetLink *self, PyObject *Py_UNUSED(ignored)) {
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    int ret = detach_filter_nl(self->netlink);
+
+    if (ret == -NLE_OBJ_NOTFOUND) {
+	    Py_RETURN_FALSE;
+    } else if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to detach the filter: %s", nl_geterror(ret));
+	    return NULL;
+    }
 
-	return PyLong_FromLong(group_id);
+    Py_RETURN_TRUE;
 }
 
-#define send_docs "Sends a message.\n@param message The message to send"
+#define set_cap_ack_docs "Enables or disables NETLINK_CAP_ACK.\nWhen enabled the acks echo only the header of the request instead of the whole request, which halves the bytes\nreceived for acks of big requests.\n@param enable True to enable"
 
-static PyObject *netlink_send(NetLink *self, PyObject *args) {
-    Message *message;
+static PyObject *netlink_set_cap_ack(NetLink *self, PyObject *args) {
+    int enable;
 
-    if (!PyArg_ParseTuple(args, "O!", &MessageType, &(message))) {
-        return NULL;
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
     }
 
-    send_nl(self->netlink, message->msg);
+    int ret = set_cap_ack_nl(self->netlink, enable);
+
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set NETLINK_CAP_ACK: %s", nl_geterror(ret));
+	    return NULL;
+    }
 
     Py_RETURN_NONE;
 }
 
-#define parse_docs "Parses message's attributes.\n@param message message to parse\n@return list of attributes (list[Attribute])."
+#define set_ext_ack_docs "Enables or disables NETLINK_EXT_ACK.\nWhen enabled the errors describe themselves (error message, offset of the invalid attribute, missing attribute),\nsee Message.parse_ack. The requests of pipeline and submit that fail get their Ack appended to their replies.\n@param enable True to enable"
 
-static PyObject *netlink_parse(NetLink *self, PyObject *args) {
-    Message *message;
+static PyObject *netlink_set_ext_ack(NetLink *self, PyObject *args) {
+    int enable;
 
-    if (!PyArg_ParseTuple(args, "O!", &MessageType, &(message))) {
-        return NULL;
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+	    return NULL;
     }
-    
-    struct nlattr* attrs[self->netlink->policies_len+1];
-    
-    parse_attr_nl(self->netlink, message->msg, attrs);
-    
-    PyObject * attribute_list = PyList_New(0);
-   
-    for (int i = 0; i < self->netlink->policies_len+1; i++) {
-	    if (!attrs[i]) continue; // checks if attributes exists
-				     
-	    Attribute *attribute = PyObject_New(Attribute, &AttributeType);
-	    attribute->len = nla_len(attrs[i]);
-	    attribute->data = (unsigned char*) malloc(attribute->len - 4);
-	    memcpy(attribute->data, nla_data(attrs[i]), attribute->len -4);
-	    attribute->type = nla_type(attrs[i]);
 
-	    PyObject *value = Py_BuildValue("O", attribute);
-
-            PyList_Append(attribute_list, (PyObject *) value);
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
     }
 
-    return attribute_list;
-}
+    int ret = set_ext_ack_nl(self->netlink, enable);
 
-#define get_family_id_docs "Getter for the family id.\n@return the family id"
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set NETLINK_EXT_ACK: %s", nl_geterror(ret));
+	    return NULL;
+    }
 
-static PyObject *netlink_get_family_id(NetLink *self, PyObject *args) {
-	return PyLong_FromLong(self->netlink->family_id);
+    Py_RETURN_NONE;
 }
 
-#define disable_seq_check_docs "Disables the sequential check."
+#define set_strict_check_docs "Enables or disables NETLINK_GET_STRICT_CHK.\nWhen enabled the kernel validates dump requests strictly and filters the dumps by their header and attributes,\nonly the matching objects are sent (see Message.link_dump, addr_dump, route_dump and neigh_dump).\n@param enable True to enable"
 
-static PyObject *netlink_disable_seq(NetLink *self, PyObject *args) {
-	disable_seq_check(self->netlink);
+static PyObject *netlink_set_strict_check(NetLink *self, PyObject *args) {
+    int enable;
 
-	Py_RETURN_NONE;
-}
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+	    return NULL;
+    }
 
-/**
- * Callback handler.
- * Used as a middle man between the cb and the python.
- *
- * @param msg The recieved msg.
- * @param callback The callback to call.
- * @return error code.
- */
-static int * cb_callback_handler(struct nl_msg *msg, PyObject *callback) {
-	PyGILState_STATE gstate;
-	gstate = PyGILState_Ensure();
-	PyObject *arglist;
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
 
-	Message *message = PyObject_New(Message, &MessageType);
-	message->msg = msg;
-	arglist = PyTuple_Pack(1, message);
-	
-	PyObject_CallObject(callback, arglist);
-	
-	Py_DECREF(arglist);
-	PyGILState_Release(gstate);
+    int ret = set_strict_check_nl(self->netlink, enable);
 
-	return 0;
+    if (ret < 0) {
+	    PyErr_Format(PyExc_OSError, "Failed to set NETLINK_GET_STRICT_CHK: %s", nl_geterror(ret));
+	    return NULL;
+    }
+
+    Py_RETURN_NONE;
 }
 
-#define modify_cb_docs "Modifies the cb of the netlink.\n@param kind kind of the object (CB_Kind).\n@param type type of the object (CB_Type)\n@param callback The callback to set"
+#define set_overrun_callback_docs "Sets a callback that is called after the receive buffer overran (messages were lost).\nThe callback gets the netlink, which is a good place to resync the state with a dump.\nrecv and recv_many return what they read before the overrun, pending requests whose answers were lost time out and a dump in progress fails.\n@param callback The callback, None to remove it"
 
-static PyObject *netlink_modify_cb(NetLink *self, PyObject *args) {
+static PyObject *netlink_set_overrun_callback(NetLink *self, PyObject *args) {
     PyObject *callback;
-    int kind;
-    int type;
 
-    if (PyArg_ParseTuple(args, "iiO:set_callback", &kind, &type,  &callback)) {
-	if (!PyCallable_Check(callback)) {
-            PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-            return NULL;
-        }
-    } else {
-	   return NULL;
-    } 
-    Py_INCREF(callback);
+    if (!PyArg_ParseTuple(args, "O", &callback)) {
+	    return NULL;
+    }
+
+    if (callback == Py_None) {
+	    Py_CLEAR(self->overrun_callback);
+	    Py_RETURN_NONE;
+    }
 
-    modify_cb(self->netlink, type, kind, cb_callback_handler, callback); 
+    if (!PyCallable_Check(callback)) {
+	    PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+	    return NULL;
+    }
+
+    Py_INCREF(callback);
+    Py_XSETREF(self->overrun_callback, callback);
 
     Py_RETURN_NONE;
 }
 
+static PyObject *netlink_get_overruns(NetLink *self, void *closure) {
+    return PyLong_FromUnsignedLong(self->netlink != NULL ? self->netlink->overruns : 0);
+}
+
 #define add_membership_docs "Adds a membership to a multicast group.\n@param group multicast group."
 
 static PyObject *netlink_add_membership(NetLink *self, PyObject *args) {
@@ -186,21 +1826,344 @@ static PyObject *netlink_drop_membership(NetLink *self, PyObject *args) {
     Py_RETURN_NONE;
 }
 
-#define recv_docs "Receives a message.\nThe appropriate cb will be called."
+#define recv_docs "Receives a message.\nThe appropriate cb will be called, the GIL is released while receiving and taken back only to call it.\n@param timeout Seconds to wait for a message, zero to not wait (default) and negative to wait forever"
 
 static PyObject *netlink_recv(NetLink *self, PyObject *args) {
-    int ret = recv_nl(self->netlink);
+    double timeout = 0;
+    int ret;
+
+    if (!PyArg_ParseTuple(args, "|d", &timeout)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+	    return NULL;
+    }
+
+    ret = netlink_wait_readable(self, timeout);
+
+    if (ret < 0) {
+	    return NULL;
+    }
+
+    if (ret == 0) {
+	    Py_RETURN_NONE;
+    }
+
+    if (self->batch_callback != NULL) {
+        if (netlink_recv_batch(self) < 0) {
+            return NULL;
+        }
+
+        Py_RETURN_NONE;
+    }
+
+    self->io_count++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = recv_nl(self->netlink);
+    Py_END_ALLOW_THREADS
+    self->io_count--;
+
+    // a callback raised, libnl stopped there.
+    if (PyErr_Occurred()) {
+	    return NULL;
+    }
 
-    if (ret != 0 && ret != -4) {
+    if (ret == -NLE_RECV_NOMEM) {
+	    return PyErr_NoMemory();
+    }
+
+    if (ret == -NLE_NOMEM) {
+	    if (netlink_overrun(self) < 0) {
+		    return NULL;
+	    }
+    } else if (ret != 0 && ret != -4) {
+	    if (!PyErr_Occurred()) {
+		    PyErr_SetString(PyExc_OSError, "Failed to receive netlink message");
+	    }
+
+	    return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+#define recv_many_docs "Receives messages until the socket has no more data or a limit is reached.\nNo callback is called, the limits are checked before every read so a datagram is never split.\nThe GIL is released while waiting and reading.\n@param max_msgs Maximum number of messages, zero for no limit (default 64)\n@param max_bytes Maximum number of bytes, zero for no limit (default 0)\n@param timeout Seconds to wait for the first message, zero to not wait (default) and negative to wait forever\n@return A tuple of [messages, reads, bytes]"
+
+static PyObject *netlink_recv_many(NetLink *self, PyObject *args) {
+    int max_msgs = 64;
+    int max_bytes = 0;
+    double timeout = 0;
+    struct recv_stats stats = {0};
+
+    if (!PyArg_ParseTuple(args, "|iid", &max_msgs, &max_bytes, &timeout)) {
+	    return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
 	    return NULL;
     }
 
+    int ready = netlink_wait_readable(self, timeout);
+
+    if (ready < 0) {
+	    return NULL;
+    }
+
+    PyObject *messages = PyList_New(0);
+
+    if (messages == NULL) {
+	    return NULL;
+    }
+
+    while (ready && (max_msgs <= 0 || stats.messages < max_msgs) && (max_bytes <= 0 || stats.bytes < max_bytes)) {
+	    unsigned char *buf;
+	    int len;
+
+	    self->io_count++;
+	    Py_BEGIN_ALLOW_THREADS
+	    len = recv_raw_nl(self->netlink, &buf);
+	    Py_END_ALLOW_THREADS
+	    self->io_count--;
+
+	    if (len == -NLE_NOMEM) {
+		    // messages were lost, return what was read so far, the next call reads what was queued after the overrun.
+		    free(buf);
+
+		    if (netlink_overrun(self) < 0) {
+			    Py_DECREF(messages);
+			    return NULL;
+		    }
+
+		    break;
+	    }
+
+	    if (len <= 0) {
+		    free(buf);
+
+		    if (len < 0 && stats.reads == 0) {
+			    Py_DECREF(messages);
+			    PyErr_Format(PyExc_OSError, "Failed to receive netlink message: %s", nl_geterror(len));
+			    return NULL;
+		    }
+
+		    break;
+	    }
+
+	    struct message_sink sink = { self, messages };
+	    int count = foreach_msg_nl(buf, len, append_to_sink, &sink);
+	    free(buf);
+
+	    if (count < 0) {
+		    Py_DECREF(messages);
+		    return NULL;
+	    }
+
+	    stats.reads++;
+	    stats.bytes += len;
+	    stats.messages += count;
+    }
+
+    return Py_BuildValue("(Nil)", messages, stats.reads, stats.bytes);
+}
+
+/**
+ * Stops the receiver, with the GIL released while joining its thread.
+ */
+static void netlink_stop_receiver(NetLink *self) {
+    struct receiver *receiver = self->receiver;
+
+    self->receiver = NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    receiver_stop(receiver);
+    Py_END_ALLOW_THREADS
+}
+
+#define start_receiver_docs "Starts a background thread that reads the socket continuously into a ring, the messages are taken with get_batch.\nBursts are absorbed by the ring instead of the socket's receive buffer, while the ring is full the thread waits.\nUntil stop_receiver nothing else may read the socket (recv, recv_many, dump...), sending is fine.\n@param ring_size Size of the ring in bytes, rounded up to a power of two (default 1MB)"
+
+static PyObject *netlink_start_receiver(NetLink *self, PyObject *args) {
+    Py_ssize_t ring_size = 1024 * 1024;
+
+    if (!PyArg_ParseTuple(args, "|n", &ring_size)) {
+        return NULL;
+    }
+
+    if (netlink_ensure_open(self) < 0) {
+        return NULL;
+    }
+
+    if (self->receiver != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "The receiver is already running.");
+        return NULL;
+    }
+
+    if (self->io_count > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Can't start the receiver while another thread is using the netlink.");
+        return NULL;
+    }
+
+    if (ring_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "ring_size must not be negative");
+        return NULL;
+    }
+
+    self->receiver = receiver_start(self->netlink, ring_size);
+
+    if (self->receiver == NULL) {
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    self->reported_overruns = self->netlink->overruns;
+
+    Py_RETURN_NONE;
+}
+
+#define stop_receiver_docs "Stops the background receiver, the messages left in its ring are dropped."
+
+static PyObject *netlink_stop_receiver_method(NetLink *self, PyObject *args) {
+    if (self->receiver == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "The receiver isn't running.");
+        return NULL;
+    }
+
+    if (self->io_count > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Can't stop the receiver while another thread is waiting on it.");
+        return NULL;
+    }
+
+    netlink_stop_receiver(self);
+
     Py_RETURN_NONE;
 }
 
+#define get_batch_docs "Takes the messages the background receiver read, the GIL is released while waiting.\nFor asyncio, watch receiver_fileno with loop.add_reader and call get_batch with a zero timeout.\n@param max_msgs Maximum number of messages, zero for no limit (default 64)\n@param timeout Seconds to wait for the first message, zero to not wait and negative to wait forever (default)\n@return list of messages, empty on timeout\n@raise OSError if the receiver stopped on a socket error (once its ring is empty)"
+
+static PyObject *netlink_get_batch(NetLink *self, PyObject *args) {
+    int max_msgs = 64;
+    double timeout = -1;
+    struct nlmsghdr *hdr = NULL;
+
+    if (!PyArg_ParseTuple(args, "|id", &max_msgs, &timeout)) {
+        return NULL;
+    }
+
+    struct receiver *receiver = self->receiver;
+
+    if (receiver == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "The receiver isn't running.");
+        return NULL;
+    }
+
+    while ((hdr = receiver_next(receiver)) == NULL && !atomic_load(&receiver->error)) {
+        int timeout_ms = timeout < 0 ? -1 : (int) (timeout * 1000);
+        int ret;
+
+        // io_count keeps the receiver from being stopped while waiting on it.
+        self->io_count++;
+        Py_BEGIN_ALLOW_THREADS
+        ret = receiver_wait(receiver, timeout_ms);
+        Py_END_ALLOW_THREADS
+        self->io_count--;
+
+        if (ret == -EINTR) {
+            if (PyErr_CheckSignals() < 0) {
+                return NULL;
+            }
+
+            continue;
+        }
+
+        if (ret < 0) {
+            errno = -ret;
+            return PyErr_SetFromErrno(PyExc_OSError);
+        }
+
+        if (ret == 0) {
+            break;
+        }
+
+        // a wait with a timeout is done once.
+        if (timeout >= 0) {
+            hdr = receiver_next(receiver);
+            break;
+        }
+    }
+
+    if (hdr == NULL && atomic_load(&receiver->error)) {
+        PyErr_Format(PyExc_OSError, "The receiver stopped: %s", nl_geterror(atomic_load(&receiver->error)));
+        return NULL;
+    }
+
+    PyObject *messages = PyList_New(0);
+
+    for (int count = 0; messages != NULL && hdr != NULL; ) {
+        if (append_raw_message(self, hdr, messages) < 0) {
+            Py_CLEAR(messages);
+            break;
+        }
+
+        if (max_msgs > 0 && ++count >= max_msgs) {
+            break;
+        }
+
+        hdr = receiver_next(receiver);
+    }
+
+    receiver_release(receiver);
+
+    if (messages != NULL && self->netlink->overruns != self->reported_overruns) {
+        self->reported_overruns = self->netlink->overruns;
+
+        if (netlink_overrun(self) < 0) {
+            Py_CLEAR(messages);
+        }
+    }
+
+    return messages;
+}
+
+#define receiver_fileno_docs "@return A file descriptor that is readable while the receiver's ring may have messages (for select/poll/asyncio)."
+
+static PyObject *netlink_receiver_fileno(NetLink *self, PyObject *args) {
+    if (self->receiver == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "The receiver isn't running.");
+        return NULL;
+    }
+
+    return PyLong_FromLong(self->receiver->data_fd);
+}
+
+#define receiver_stats_docs "@return dict of the receiver's counters: datagrams, messages, bytes, full (times its thread waited for room in the ring) and dropped (messages bigger than a quarter of the ring)"
+
+static PyObject *netlink_receiver_stats(NetLink *self, PyObject *args) {
+    if (self->receiver == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "The receiver isn't running.");
+        return NULL;
+    }
+
+    struct receiver_stats *stats = &self->receiver->stats;
+
+    return Py_BuildValue("{s:k,s:k,s:k,s:k,s:k}",
+                         "datagrams", atomic_load_explicit(&stats->datagrams, memory_order_relaxed),
+                         "messages", atomic_load_explicit(&stats->messages, memory_order_relaxed),
+                         "bytes", atomic_load_explicit(&stats->bytes, memory_order_relaxed),
+                         "full", atomic_load_explicit(&stats->full, memory_order_relaxed),
+                         "dropped", atomic_load_explicit(&stats->dropped, memory_order_relaxed));
+}
+
 #define close_docs "Closes netlink connection.\n"
 
 static PyObject *netlink_close(NetLink *self, PyObject *args) {
+    if (self->io_count > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Can't close a netlink while another thread is using it.");
+        return NULL;
+    }
+
+    if (self->receiver != NULL) {
+        netlink_stop_receiver(self);
+    }
+
     if (self->netlink != NULL) {
         close_nl(self->netlink);
         Py_RETURN_NONE;
@@ -219,6 +2182,27 @@ static PyObject *NetLink_new(PyTypeObject *type, PyObject *args,
 }
 
 static void NetLink_dealloc(NetLink *self) {
+    for (int i = 0; i < self->pending.capacity; i++) {
+        if (self->pending.slots[i].state != PENDING_FREE) {
+            Py_XDECREF((PyObject *) self->pending.slots[i].data);
+        }
+    }
+
+    pending_free(&self->pending);
+    router_clear(&self->router, release_handler);
+
+    for (int i = 0; i <= NL_CB_TYPE_MAX; i++) {
+        Py_XDECREF(self->callbacks[i]);
+    }
+
+    Py_XDECREF(self->batch_callback);
+    Py_XDECREF(self->overrun_callback);
+    policy_table_unref(self->policy_table);
+
+    if (self->receiver != NULL) {
+        netlink_stop_receiver(self);
+    }
+
     if (self->netlink != NULL) {
         close_nl(self->netlink);
         free(self->netlink->policies);
@@ -228,59 +2212,57 @@ static void NetLink_dealloc(NetLink *self) {
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-static struct nla_policy * get_policies(AttributePolicy **policies, int policies_len, struct nla_policy *nla_policies) {
-    for (int i = 0; i < policies_len; i++) {
-	 nla_policies[i] = policies[i]->policy;
-    }
-
-    return nla_policies;
-}
-
-static void NetLink_init(NetLink *self, PyObject *args, PyObject *kwds) {
+static int NetLink_init(NetLink *self, PyObject *args, PyObject *kwds) {
     PyObject *policies_list;
     int family_id;
     int protocol;
     int hdrlen;
 
-    if (!PyArg_ParseTuple(args, "iiiO", &family_id, &protocol, &hdrlen, &policies_list)) return;
+    // a second __init__ would leak the socket, the policies and the pending requests.
+    if (self->policy_table != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "NetLink is already initialised");
+        return -1;
+    }
+
+    if (!PyArg_ParseTuple(args, "iiiO", &family_id, &protocol, &hdrlen, &policies_list)) return -1;
 
     if (!PyList_Check(policies_list)) {
 	    PyErr_SetString(PyExc_TypeError, "Attribute must be a list");
-	    return;
+	    return -1;
     }
 
-    int policies_len = PyList_Size(policies_list);
-    AttributePolicy ** policies = (AttributePolicy **) malloc(sizeof(AttributePolicy *) * policies_len); 
-
-    if (policies == NULL) {
-        return;
+    if (self->message_type == NULL) {
+        self->message_type = &MessageType;
     }
 
-    for (int i = 0; i < policies_len; i++) {
-	    PyObject *item = PyList_GetItem(policies_list, i);
+    // validates the policies as well.
+    self->policy_table = policy_table_from_list(policies_list);
 
-	    if (!PyObject_IsInstance(item, (PyObject *) &AttributePolicyType)) {
-		    PyErr_SetString(PyExc_TypeError, "List must contain AttributePolicy");
-		    Py_DECREF(item);
-		    return;
-	    }
+    if (self->policy_table == NULL) {
+        return -1;
+    }
 
-	    policies[i] = (AttributePolicy *) item; 
+    if (pending_init(&self->pending, PENDING_DEFAULT_WINDOW) < 0) {
+        PyErr_NoMemory();
+        return -1;
     }
 
     self->netlink = (struct netlink *)malloc(sizeof(struct netlink));
 
-    struct nla_policy nla_policies[policies_len];
-
-    get_policies(policies, policies_len, nla_policies);
-
+    if (self->netlink == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
 
-    self->netlink = initialize_netlink(self->netlink, protocol, family_id, &nla_policies[0], policies_len, hdrlen);
+    self->netlink = initialize_netlink(self->netlink, protocol, family_id, self->policy_table->policies, self->policy_table->maxtype, hdrlen);
 
     if (!self->netlink->sock) {
         PyErr_SetString(PyExc_ConnectionRefusedError,
                         "Couldn't connect to netlink.");
+        return -1;
     }
+
+    return 0;
 }
 
 static PyMemberDef NetLink_members[] = {
@@ -288,17 +2270,49 @@ static PyMemberDef NetLink_members[] = {
     {NULL} /* Sentinel */
 };
 
+static PyGetSetDef NetLink_getset[] = {
+    {"overruns", (getter) netlink_get_overruns, NULL, "Number of times the receive buffer overran, every overrun lost messages.", NULL},
+    {NULL} /* Sentinel */
+};
+
 static PyMethodDef NetLink_methods[] = {
     {"send", (PyCFunction) netlink_send, METH_VARARGS, send_docs},
+    {"send_batch", (PyCFunction) netlink_send_batch, METH_VARARGS, send_batch_docs},
+    {"dump", (PyCFunction) netlink_dump, METH_VARARGS, dump_docs},
+    {"pipeline", (PyCFunction) netlink_pipeline, METH_VARARGS, pipeline_docs},
+    {"submit", (PyCFunction) netlink_submit, METH_VARARGS, submit_docs},
+    {"completions", (PyCFunction) netlink_completions, METH_VARARGS, completions_docs},
+    {"set_window", (PyCFunction) netlink_set_window, METH_VARARGS, set_window_docs},
     {"recv", (PyCFunction) netlink_recv, METH_VARARGS, recv_docs},
+    {"recv_many", (PyCFunction) netlink_recv_many, METH_VARARGS, recv_many_docs},
+    {"fileno", (PyCFunction) netlink_fileno, METH_NOARGS, fileno_docs},
+    {"start_receiver", (PyCFunction) netlink_start_receiver, METH_VARARGS, start_receiver_docs},
+    {"stop_receiver", (PyCFunction) netlink_stop_receiver_method, METH_NOARGS, stop_receiver_docs},
+    {"get_batch", (PyCFunction) netlink_get_batch, METH_VARARGS, get_batch_docs},
+    {"receiver_fileno", (PyCFunction) netlink_receiver_fileno, METH_NOARGS, receiver_fileno_docs},
+    {"receiver_stats", (PyCFunction) netlink_receiver_stats, METH_NOARGS, receiver_stats_docs},
+    {"set_rcvbuf", (PyCFunction) netlink_set_rcvbuf, METH_VARARGS, set_rcvbuf_docs},
+    {"get_rcvbuf", (PyCFunction) netlink_get_rcvbuf, METH_NOARGS, get_rcvbuf_docs},
+    {"set_recv_buffer", (PyCFunction) netlink_set_recv_buffer, METH_VARARGS, set_recv_buffer_docs},
+    {"set_no_enobufs", (PyCFunction) netlink_set_no_enobufs, METH_VARARGS, set_no_enobufs_docs},
+    {"set_overrun_callback", (PyCFunction) netlink_set_overrun_callback, METH_VARARGS, set_overrun_callback_docs},
+    {"set_cap_ack", (PyCFunction) netlink_set_cap_ack, METH_VARARGS, set_cap_ack_docs},
+    {"set_ext_ack", (PyCFunction) netlink_set_ext_ack, METH_VARARGS, set_ext_ack_docs},
+    {"set_strict_check", (PyCFunction) netlink_set_strict_check, METH_VARARGS, set_strict_check_docs},
+    {"attach_filter", (PyCFunction) netlink_attach_filter, METH_VARARGS, attach_filter_docs},
+    {"detach_filter", (PyCFunction) netlink_detach_filter, METH_NOARGS, detach_filter_docs},
     {"get_family_id", (PyCFunction)netlink_get_family_id, METH_VARARGS, get_family_id_docs},
     {"disable_seq_check", (PyCFunction)netlink_disable_seq, METH_VARARGS, disable_seq_check_docs},
     {"close", (PyCFunction) netlink_close, METH_VARARGS,
      close_docs},
     {"modify_cb", (PyCFunction) netlink_modify_cb, METH_VARARGS, modify_cb_docs},
+    {"route", (PyCFunction) netlink_route, METH_VARARGS | METH_KEYWORDS, route_docs},
+    {"dispatch", (PyCFunction) netlink_dispatch, METH_VARARGS, dispatch_docs},
     {"parse_message_attributes", (PyCFunction) netlink_parse, METH_VARARGS, parse_docs},
     {"resolve_genl_family_id", (PyCFunction) netlink_resolve_genl_family_id, METH_VARARGS | METH_CLASS, resolve_genl_family_id_docs},
     {"resolve_genl_group_id", (PyCFunction) netlink_resolve_genl_group_id, METH_VARARGS | METH_CLASS, resolve_genl_group_id_docs},
+    {"genl_family", (PyCFunction) netlink_genl_family, METH_VARARGS | METH_CLASS, genl_family_docs},
+    {"genl_cache_invalidate", (PyCFunction) netlink_genl_cache_invalidate, METH_NOARGS | METH_CLASS, genl_cache_invalidate_docs},
     {"add_membership", (PyCFunction) netlink_add_membership, METH_VARARGS, add_membership_docs},
     {"drop_membership", (PyCFunction) netlink_drop_membership, METH_VARARGS, drop_membership_docs},
     {NULL} /* Sentinel */
@@ -333,7 +2347,7 @@ PyTypeObject NetLinkType = {
     0,                      /* tp_iternext */
     NetLink_methods,        /* tp_methods */
     NetLink_members,        /* tp_members */
-    0,                      /* tp_getset */
+    NetLink_getset,         /* tp_getset */
     0,                      /* tp_base */
     0,                      /* tp_dict */
     0,                      /* tp_descr_get */
@@ -23,6 +23,9 @@
 #include <structmember.h>
 #include "netlink.h"
 #include "attribute_policy.h"
+#include "pending.h"
+#include "receiver.h"
+#include "router.h"
 
 /**
  * Represents NetLink class.
@@ -30,8 +33,56 @@
 typedef struct {
     PyObject_HEAD
     struct netlink *netlink;
+    int io_count; // number of threads currently doing I/O on the socket without the GIL.
+    PyObject *callbacks[NL_CB_TYPE_MAX + 1]; // the callbacks installed by modify_cb, by CB_Type.
+    PyObject *batch_callback; // the callback installed by modify_cb with CB_BATCH, called once per recv.
+    struct pending_table pending; // requests waiting for their answer, the data of each is a list of its replies.
+    PyObject *overrun_callback; // called after the receive buffer overran, NULL if none.
+    struct policy_table *policy_table; // the attribute policies, with the policies of the nested attributes.
+    PyTypeObject *message_type; // type of the received messages, Message or one of its C subclasses.
+    struct receiver *receiver; // the background receiver reading the socket, NULL if not started.
+    unsigned long reported_overruns; // overruns counted by the receiver that were already reported.
+    struct router router; // the handlers dispatch routes the messages to.
+    int pktinfo; // whether the kernel reports the multicast group of every datagram.
 } NetLink; 
 
 extern PyTypeObject NetLinkType;
 
+/**
+ * Checks that the netlink is still connected.
+ *
+ * @param self The netlink.
+ * @return zero if connected, -1 with an exception set otherwise.
+ */
+int netlink_ensure_open(NetLink *self);
+
+/**
+ * Waits with the GIL released until the socket is readable.
+ * Signals are checked whenever the wait is interrupted.
+ *
+ * @param self The netlink.
+ * @param timeout Timeout in seconds, zero to not wait at all and negative to wait forever.
+ * @return 1 if readable, 0 on timeout, -1 with an exception set upon failure.
+ */
+int netlink_wait_readable(NetLink *self, double timeout);
+
+/**
+ * Reports a receive buffer overrun (the overrun is already counted by the C layer),
+ * by calling the callback installed by set_overrun_callback.
+ *
+ * @param self The netlink.
+ * @return zero upon success, -1 with an exception set if the callback raised.
+ */
+int netlink_overrun(NetLink *self);
+
+/**
+ * Routes a received message to the pending request it answers,
+ * messages no request is waiting for are passed to the callback installed by modify_cb.
+ *
+ * @param hdr The message.
+ * @param arg The netlink.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+int netlink_dispatch_message(struct nlmsghdr *hdr, void *arg);
+
 #endif
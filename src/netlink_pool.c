@@ -0,0 +1,603 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "netlink_pool.h"
+#include "pythread.h"
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <limits.h>
+
+#define POOL_WAIT_SLICE 50 // milliseconds
+
+/**
+ * Finds the index of a NetLink of the pool.
+ *
+ * @return The index, -1 with a ValueError set if it isn't in the pool.
+ */
+static int pool_index(NetLinkPool *self, PyObject *netlink) {
+	for (int i = 0; i < self->size; i++) {
+		if (PyTuple_GET_ITEM(self->sockets, i) == netlink) {
+			return i;
+		}
+	}
+
+	PyErr_SetString(PyExc_ValueError, "The netlink isn't part of the pool");
+	return -1;
+}
+
+/**
+ * Leases a NetLink, with the GIL held and one counted as free in the semaphore already taken.
+ * The thread gets the NetLink it had last if it is free, otherwise the next free one round robin.
+ *
+ * @return The index of the leased NetLink.
+ */
+static int pool_take(NetLinkPool *self) {
+	unsigned long thread = PyThread_get_thread_ident();
+	int index = -1;
+
+	for (int i = 0; i < self->size && index < 0; i++) {
+		if (!self->leased[i] && self->owners[i] == thread) {
+			index = i;
+		}
+	}
+
+	for (int i = 0; i < self->size && index < 0; i++) {
+		int candidate = (self->next + i) % self->size;
+
+		if (!self->leased[candidate]) {
+			index = candidate;
+			self->next = (candidate + 1) % self->size;
+		}
+	}
+
+	self->leased[index] = 1;
+	self->owners[index] = thread;
+
+	return index;
+}
+
+/**
+ * Leases a NetLink, waiting with the GIL released while all of them are leased.
+ *
+ * @param self The pool.
+ * @param timeout Seconds to wait, negative to wait forever.
+ * @return The index of the leased NetLink, -1 with an exception set upon failure (TimeoutError if none got free).
+ */
+static int pool_acquire(NetLinkPool *self, double timeout) {
+	struct timespec deadline;
+	int ret;
+
+	if (self->sockets == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "The pool isn't initialized");
+		return -1;
+	}
+
+	if (sem_trywait(&self->free) == 0) {
+		return pool_take(self);
+	}
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += (time_t) timeout;
+	deadline.tv_nsec += (long) ((timeout - (time_t) timeout) * 1e9);
+
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	do {
+		Py_BEGIN_ALLOW_THREADS
+		ret = timeout < 0 ? sem_wait(&self->free) : sem_timedwait(&self->free, &deadline);
+		Py_END_ALLOW_THREADS
+
+		if (ret < 0 && errno == EINTR && PyErr_CheckSignals() < 0) {
+			return -1;
+		}
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		PyErr_SetString(PyExc_TimeoutError, "Every netlink of the pool is leased");
+		return -1;
+	}
+
+	return pool_take(self);
+}
+
+/**
+ * Gives a leased NetLink back.
+ *
+ * @param self The pool.
+ * @param index The NetLink's index.
+ */
+static void pool_release(NetLinkPool *self, int index) {
+	self->leased[index] = 0;
+	sem_post(&self->free);
+}
+
+#define acquire_docs "Leases a netlink of the pool to the calling thread until release.\nA thread gets back the netlink it had last when it is free, otherwise the next free one (round robin).\nThe GIL is released while waiting for a free netlink.\n@param timeout Seconds to wait, negative to wait forever (default)\n@return NetLink\n@raise TimeoutError if every netlink stayed leased"
+
+static PyObject *pool_acquire_method(NetLinkPool *self, PyObject *args) {
+	double timeout = -1;
+
+	if (!PyArg_ParseTuple(args, "|d", &timeout)) {
+		return NULL;
+	}
+
+	int index = pool_acquire(self, timeout);
+
+	if (index < 0) {
+		return NULL;
+	}
+
+	PyObject *netlink = PyTuple_GET_ITEM(self->sockets, index);
+	Py_INCREF(netlink);
+
+	return netlink;
+}
+
+#define release_docs "Gives a leased netlink back to the pool.\n@param netlink The netlink acquire returned"
+
+static PyObject *pool_release_method(NetLinkPool *self, PyObject *args) {
+	PyObject *netlink;
+
+	if (!PyArg_ParseTuple(args, "O", &netlink)) {
+		return NULL;
+	}
+
+	if (self->sockets == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "The pool isn't initialized");
+		return NULL;
+	}
+
+	int index = pool_index(self, netlink);
+
+	if (index < 0) {
+		return NULL;
+	}
+
+	if (!self->leased[index]) {
+		PyErr_SetString(PyExc_ValueError, "The netlink isn't leased");
+		return NULL;
+	}
+
+	pool_release(self, index);
+
+	Py_RETURN_NONE;
+}
+
+/**
+ * Calls a method of a leased NetLink.
+ *
+ * @param self The pool.
+ * @param name The method.
+ * @param args The arguments.
+ * @param index Set to the index of the NetLink.
+ * @return The result, NULL with an exception set upon failure.
+ */
+static PyObject *pool_call(NetLinkPool *self, const char *name, PyObject *args, int *index) {
+	*index = pool_acquire(self, -1);
+
+	if (*index < 0) {
+		return NULL;
+	}
+
+	PyObject *method = PyObject_GetAttrString(PyTuple_GET_ITEM(self->sockets, *index), name);
+	PyObject *result = NULL;
+
+	if (method != NULL) {
+		result = PyObject_Call(method, args, NULL);
+		Py_DECREF(method);
+	}
+
+	pool_release(self, *index);
+
+	return result;
+}
+
+#define pool_pipeline_docs "Runs NetLink.pipeline on a netlink leased for the call, threads calling it run their requests in parallel.\n@param messages The requests (list[Message])\n@param timeout Seconds until the requests time out, negative to wait forever (default 1)\n@return list of tuples of [error, replies] in the order of the requests"
+
+static PyObject *pool_pipeline(NetLinkPool *self, PyObject *args) {
+	int index;
+
+	return pool_call(self, "pipeline", args, &index);
+}
+
+#define pool_submit_docs "Runs NetLink.submit on a netlink leased for the call, collect the requests with completions.\n@param messages The requests (list[Message])\n@param timeout Seconds until the requests time out (default 1)\n@return list of tuples of [shard, seq], shard is the index of the netlink the requests were sent on"
+
+static PyObject *pool_submit(NetLinkPool *self, PyObject *args) {
+	int index;
+	PyObject *seqs = pool_call(self, "submit", args, &index);
+
+	if (seqs == NULL) {
+		return NULL;
+	}
+
+	PyObject *result = PyList_New(PyList_GET_SIZE(seqs));
+
+	for (Py_ssize_t i = 0; result != NULL && i < PyList_GET_SIZE(seqs); i++) {
+		PyObject *item = Py_BuildValue("(iO)", index, PyList_GET_ITEM(seqs, i));
+
+		if (item == NULL) {
+			Py_CLEAR(result);
+			break;
+		}
+
+		PyList_SET_ITEM(result, i, item);
+	}
+
+	Py_DECREF(seqs);
+
+	return result;
+}
+
+/**
+ * Collects the completions of every NetLink that isn't leased, without waiting.
+ *
+ * @param self The pool.
+ * @param merged The list the tuples of [shard, seq, error, replies] are appended to.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int pool_collect(NetLinkPool *self, PyObject *merged) {
+	for (int i = 0; i < self->size; i++) {
+		if (self->leased[i]) {
+			continue;
+		}
+
+		// leased meanwhile so that no other thread uses it, a failed trywait means a waiting thread is about to lease it.
+		if (sem_trywait(&self->free) < 0) {
+			continue;
+		}
+
+		self->leased[i] = 1;
+
+		PyObject *done = PyObject_CallMethod(PyTuple_GET_ITEM(self->sockets, i), "completions", NULL);
+
+		pool_release(self, i);
+
+		if (done == NULL) {
+			return -1;
+		}
+
+		for (Py_ssize_t j = 0; j < PyList_GET_SIZE(done); j++) {
+			PyObject *completion = PyList_GET_ITEM(done, j);
+			PyObject *item = Py_BuildValue("(iOOO)", i, PyTuple_GET_ITEM(completion, 0),
+			                               PyTuple_GET_ITEM(completion, 1), PyTuple_GET_ITEM(completion, 2));
+
+			if (item == NULL || PyList_Append(merged, item) < 0) {
+				Py_XDECREF(item);
+				Py_DECREF(done);
+				return -1;
+			}
+
+			Py_DECREF(item);
+		}
+
+		Py_DECREF(done);
+	}
+
+	return 0;
+}
+
+/**
+ * Waits with the GIL released until a NetLink that isn't leased is readable.
+ *
+ * @param self The pool.
+ * @param timeout Milliseconds to wait.
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int pool_wait_readable(NetLinkPool *self, int timeout) {
+	struct pollfd *fds = PyMem_Calloc(self->size, sizeof(struct pollfd));
+	int count = 0;
+	int ret;
+
+	if (fds == NULL) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	for (int i = 0; i < self->size; i++) {
+		NetLink *netlink = (NetLink *) PyTuple_GET_ITEM(self->sockets, i);
+
+		if (!self->leased[i] && netlink->netlink != NULL && netlink->netlink->sock != NULL) {
+			fds[count].fd = nl_socket_get_fd(netlink->netlink->sock);
+			fds[count].events = POLLIN;
+			count++;
+		}
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	ret = poll(fds, count, timeout);
+	Py_END_ALLOW_THREADS
+
+	PyMem_Free(fds);
+
+	if (ret < 0 && errno == EINTR) {
+		return PyErr_CheckSignals();
+	}
+
+	if (ret < 0) {
+		PyErr_SetFromErrno(PyExc_OSError);
+		return -1;
+	}
+
+	return 0;
+}
+
+#define pool_completions_docs "Collects the completed (or timed out) requests of every netlink that isn't leased, merged.\nThe GIL is released while waiting.\n@param timeout Seconds to wait when nothing completed yet, zero to not wait (default) and negative to wait forever\n@return list of tuples of [shard, seq, error, replies]"
+
+static PyObject *pool_completions(NetLinkPool *self, PyObject *args) {
+	double timeout = 0;
+	struct timespec now;
+
+	if (!PyArg_ParseTuple(args, "|d", &timeout)) {
+		return NULL;
+	}
+
+	if (self->sockets == NULL) {
+		PyErr_SetString(PyExc_RuntimeError, "The pool isn't initialized");
+		return NULL;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double deadline = now.tv_sec + now.tv_nsec / 1e9 + timeout;
+	PyObject *merged = PyList_New(0);
+
+	while (merged != NULL) {
+		if (pool_collect(self, merged) < 0) {
+			Py_CLEAR(merged);
+			break;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		double remaining = deadline - (now.tv_sec + now.tv_nsec / 1e9);
+
+		if (PyList_GET_SIZE(merged) > 0 || timeout == 0 || (timeout > 0 && remaining <= 0)) {
+			break;
+		}
+
+		// woken up regularly, requests time out without any traffic.
+		int slice = timeout < 0 || remaining > POOL_WAIT_SLICE / 1000.0 ? POOL_WAIT_SLICE : (int) (remaining * 1000) + 1;
+
+		if (pool_wait_readable(self, slice) < 0) {
+			Py_CLEAR(merged);
+		}
+	}
+
+	return merged;
+}
+
+#define pool_close_docs "Closes every netlink of the pool.\n@raise RuntimeError if a netlink is leased"
+
+static PyObject *pool_close(NetLinkPool *self, PyObject *Py_UNUSED(ignored)) {
+	if (self->sockets == NULL) {
+		Py_RETURN_NONE;
+	}
+
+	for (int i = 0; i < self->size; i++) {
+		if (self->leased[i]) {
+			PyErr_SetString(PyExc_RuntimeError, "Can't close a pool while a netlink is leased");
+			return NULL;
+		}
+	}
+
+	for (int i = 0; i < self->size; i++) {
+		PyObject *result = PyObject_CallMethod(PyTuple_GET_ITEM(self->sockets, i), "close", NULL);
+
+		if (result == NULL) {
+			return NULL;
+		}
+
+		Py_DECREF(result);
+	}
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *NetLinkPool_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+	NetLinkPool *self = (NetLinkPool *) type->tp_alloc(type, 0);
+
+	return (PyObject *) self;
+}
+
+/**
+ * Frees the pool's NetLinks and bookkeeping.
+ */
+static void pool_clear(NetLinkPool *self) {
+	if (self->sockets != NULL) {
+		sem_destroy(&self->free);
+	}
+
+	Py_CLEAR(self->sockets);
+	PyMem_Free(self->leased);
+	PyMem_Free(self->owners);
+	self->leased = NULL;
+	self->owners = NULL;
+	self->size = 0;
+}
+
+static void NetLinkPool_dealloc(NetLinkPool *self) {
+	pool_clear(self);
+
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/**
+ * NetLinkPool(size, *args, netlink_type=NetLink, **kwargs), the NetLinks are created with netlink_type(*args, **kwargs).
+ */
+static int NetLinkPool_init(NetLinkPool *self, PyObject *args, PyObject *kwds) {
+	PyObject *type = (PyObject *) &NetLinkType;
+	PyObject *rest = NULL;
+	PyObject *kwargs = NULL;
+	PyObject *sockets = NULL;
+	int size;
+
+	if (self->sockets != NULL) {
+		// threads may be waiting on the semaphore or holding leased netlinks.
+		PyErr_SetString(PyExc_RuntimeError, "NetLinkPool is already initialised");
+		return -1;
+	}
+
+	if (PyTuple_GET_SIZE(args) < 1) {
+		PyErr_SetString(PyExc_TypeError, "NetLinkPool expects the number of netlinks");
+		return -1;
+	}
+
+	long requested_size = PyLong_AsLong(PyTuple_GET_ITEM(args, 0));
+
+	if (requested_size == -1 && PyErr_Occurred()) {
+		return -1;
+	}
+
+	size = requested_size > INT_MAX ? INT_MAX : (int) requested_size;
+
+	if (size <= 0) {
+		PyErr_SetString(PyExc_ValueError, "A pool has at least one netlink");
+		return -1;
+	}
+
+	if (kwds != NULL) {
+		kwargs = PyDict_Copy(kwds);
+
+		if (kwargs == NULL) {
+			return -1;
+		}
+
+		PyObject *requested = PyDict_GetItemString(kwargs, "netlink_type");
+
+		if (requested != NULL) {
+			if (!PyType_Check(requested) || !PyType_IsSubtype((PyTypeObject *) requested, &NetLinkType)) {
+				PyErr_SetString(PyExc_TypeError, "netlink_type must be NetLink or one of its subclasses");
+				Py_DECREF(kwargs);
+				return -1;
+			}
+
+			type = requested;
+			Py_INCREF(type);
+			PyDict_DelItemString(kwargs, "netlink_type");
+		}
+	}
+
+	rest = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args));
+	sockets = rest != NULL ? PyTuple_New(size) : NULL;
+
+	for (int i = 0; sockets != NULL && i < size; i++) {
+		// every socket gets its own port id from libnl.
+		PyObject *netlink = PyObject_Call(type, rest, kwargs);
+
+		if (netlink == NULL) {
+			Py_CLEAR(sockets);
+			break;
+		}
+
+		PyTuple_SET_ITEM(sockets, i, netlink);
+	}
+
+	if (type != (PyObject *) &NetLinkType) {
+		Py_DECREF(type);
+	}
+
+	Py_XDECREF(rest);
+	Py_XDECREF(kwargs);
+
+	if (sockets == NULL) {
+		return -1;
+	}
+
+	self->leased = PyMem_Calloc(size, sizeof(char));
+	self->owners = PyMem_Calloc(size, sizeof(unsigned long));
+
+	if (self->leased == NULL || self->owners == NULL || sem_init(&self->free, 0, size) < 0) {
+		PyMem_Free(self->leased);
+		PyMem_Free(self->owners);
+		self->leased = NULL;
+		self->owners = NULL;
+		Py_DECREF(sockets);
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	self->sockets = sockets;
+	self->size = size;
+	self->next = 0;
+
+	return 0;
+}
+
+static Py_ssize_t NetLinkPool_len(NetLinkPool *self) {
+	return self->size;
+}
+
+static PySequenceMethods NetLinkPool_as_sequence = {
+    (lenfunc)NetLinkPool_len, /* sq_length */
+};
+
+static PyMemberDef NetLinkPool_members[] = {
+    {"sockets", T_OBJECT, offsetof(NetLinkPool, sockets), READONLY, "The netlinks of the pool (tuple), their index is the shard of the completions."},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef NetLinkPool_methods[] = {
+    {"acquire", (PyCFunction) pool_acquire_method, METH_VARARGS, acquire_docs},
+    {"release", (PyCFunction) pool_release_method, METH_VARARGS, release_docs},
+    {"pipeline", (PyCFunction) pool_pipeline, METH_VARARGS, pool_pipeline_docs},
+    {"submit", (PyCFunction) pool_submit, METH_VARARGS, pool_submit_docs},
+    {"completions", (PyCFunction) pool_completions, METH_VARARGS, pool_completions_docs},
+    {"close", (PyCFunction) pool_close, METH_NOARGS, pool_close_docs},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject NetLinkPoolType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.NetLinkPool", /* tp_name */
+    sizeof(NetLinkPool),                              /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)NetLinkPool_dealloc,                  /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    &NetLinkPool_as_sequence,                         /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,         /* tp_flags */
+    "Pool of netlinks (one socket and port id each) shared by threads.\nNetLinkPool(size, *args, netlink_type=NetLink, **kwargs) creates size netlinks with netlink_type(*args, **kwargs).", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    0,                      /* tp_iter */
+    0,                      /* tp_iternext */
+    NetLinkPool_methods,    /* tp_methods */
+    NetLinkPool_members,    /* tp_members */
+    0,                      /* tp_getset */
+    0,                      /* tp_base */
+    0,                      /* tp_dict */
+    0,                      /* tp_descr_get */
+    0,                      /* tp_descr_set */
+    0,                      /* tp_dictoffset */
+    (initproc)NetLinkPool_init, /* tp_init */
+    0,                      /* tp_alloc */
+    NetLinkPool_new,        /* tp_new */
+};
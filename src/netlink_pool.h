@@ -0,0 +1,51 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef NETLINK_POOL_H
+#define NETLINK_POOL_H
+
+#include "Python.h"
+#include <structmember.h>
+#include <semaphore.h>
+#include "netlink_class.h"
+
+/**
+ * A pool of NetLinks (each with its own socket and port id) shared by threads.
+ * A socket is leased to one thread at a time, so its sequence numbers and pending requests
+ * are never touched concurrently, while the threads do their I/O in parallel without the GIL.
+ *
+ * sockets -> Tuple of the NetLinks.
+ * size -> Number of NetLinks.
+ * leased -> Whether each NetLink is leased, only changed with the GIL held.
+ * owners -> Thread that leased each NetLink last, a thread gets its own NetLink back when it is free.
+ * next -> Round robin cursor of the threads that have no NetLink yet.
+ * free -> Counts the NetLinks that aren't leased, waited on without the GIL.
+ */
+typedef struct {
+    PyObject_HEAD
+    PyObject *sockets;
+    int size;
+    char *leased;
+    unsigned long *owners;
+    int next;
+    sem_t free;
+} NetLinkPool;
+
+extern PyTypeObject NetLinkPoolType;
+
+#endif
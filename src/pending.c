@@ -0,0 +1,254 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pending.h"
+
+/**
+ * Initializes a table.
+ *
+ * @param table The table.
+ * @param window Maximum number of waiting requests.
+ * @return zero upon success, -ENOMEM upon failure.
+ */
+int pending_init(struct pending_table *table, int window) {
+    int capacity = 8;
+
+    while (capacity < window * 2) {
+        capacity *= 2;
+    }
+
+    table->slots = calloc(capacity, sizeof(struct pending_request));
+
+    if (table->slots == NULL) {
+        return -ENOMEM;
+    }
+
+    table->capacity = capacity;
+    table->window = window;
+    table->count = 0;
+    table->waiting = 0;
+
+    return 0;
+}
+
+/**
+ * Frees the table's slots, the data of the requests is the user's to free.
+ *
+ * @param table The table.
+ */
+void pending_free(struct pending_table *table) {
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+    table->waiting = 0;
+}
+
+/**
+ * Returns the slot a sequence number hashes to.
+ */
+static int pending_slot(struct pending_table *table, unsigned int seq) {
+    // sequence numbers are mostly consecutive, so they spread well by themselves.
+    return seq & (table->capacity - 1);
+}
+
+/**
+ * Doubles the number of slots, rehashing every request.
+ *
+ * @param table The table.
+ * @return zero upon success, -ENOMEM upon failure.
+ */
+static int pending_grow(struct pending_table *table) {
+    struct pending_request *old = table->slots;
+    int old_capacity = table->capacity;
+    struct pending_request *slots = calloc(old_capacity * 2, sizeof(struct pending_request));
+
+    if (slots == NULL) {
+        return -ENOMEM;
+    }
+
+    table->slots = slots;
+    table->capacity = old_capacity * 2;
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].state == PENDING_FREE) continue;
+
+        int j = pending_slot(table, old[i].seq);
+
+        while (table->slots[j].state != PENDING_FREE) {
+            j = (j + 1) & (table->capacity - 1);
+        }
+
+        table->slots[j] = old[i];
+    }
+
+    free(old);
+
+    return 0;
+}
+
+/**
+ * Adds a waiting request.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @param ack_seq Sequence number of the request whose ack completes this one.
+ * @param deadline Time (in milliseconds) the request times out at, PENDING_NO_DEADLINE for never.
+ * @return The request, NULL if the window is full, the seq is already in the table or out of memory.
+ */
+struct pending_request *pending_add(struct pending_table *table, unsigned int seq, unsigned int ack_seq, long long deadline) {
+    if (table->waiting >= table->window || pending_find(table, seq) != NULL) {
+        return NULL;
+    }
+
+    if ((table->count + 1) * 2 > table->capacity && pending_grow(table) < 0) {
+        return NULL;
+    }
+
+    int i = pending_slot(table, seq);
+
+    while (table->slots[i].state != PENDING_FREE) {
+        i = (i + 1) & (table->capacity - 1);
+    }
+
+    table->slots[i] = (struct pending_request) {
+        .seq = seq,
+        .ack_seq = ack_seq,
+        .state = PENDING_WAITING,
+        .deadline = deadline,
+    };
+    table->count++;
+    table->waiting++;
+
+    return &table->slots[i];
+}
+
+/**
+ * Finds a request.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @return The request, NULL if it isn't in the table.
+ */
+struct pending_request *pending_find(struct pending_table *table, unsigned int seq) {
+    if (table->count == 0) {
+        return NULL;
+    }
+
+    for (int i = pending_slot(table, seq); table->slots[i].state != PENDING_FREE; i = (i + 1) & (table->capacity - 1)) {
+        if (table->slots[i].seq == seq) {
+            return &table->slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Removes a request, pointers to other requests may be invalidated.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @return The removed request's data, NULL if it isn't in the table.
+ */
+void *pending_remove(struct pending_table *table, unsigned int seq) {
+    struct pending_request *request = pending_find(table, seq);
+    int mask = table->capacity - 1;
+
+    if (request == NULL) {
+        return NULL;
+    }
+
+    void *data = request->data;
+    int hole = request - table->slots;
+
+    table->waiting -= request->state == PENDING_WAITING;
+    request->state = PENDING_FREE;
+    table->count--;
+
+    // backward shift deletion, moves back every entry of the cluster that can't be found past the hole.
+    for (int i = (hole + 1) & mask; table->slots[i].state != PENDING_FREE; i = (i + 1) & mask) {
+        int home = pending_slot(table, table->slots[i].seq);
+
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table->slots[hole] = table->slots[i];
+            table->slots[i].state = PENDING_FREE;
+            hole = i;
+        }
+    }
+
+    return data;
+}
+
+/**
+ * Completes a waiting request.
+ * Also completes every waiting request that is acked by it with success, whatever its own outcome:
+ * the kernel handles the requests in order and answers the ones without an ack only when they fail,
+ * so by the time the ack carrier is answered those that didn't answer succeeded.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @param error The outcome, zero upon success or a negative errno.
+ * @return Number of completed requests.
+ */
+int pending_complete(struct pending_table *table, unsigned int seq, int error) {
+    struct pending_request *request = pending_find(table, seq);
+    int completed = 0;
+
+    if (request == NULL || request->state != PENDING_WAITING) {
+        return 0;
+    }
+
+    request->state = PENDING_DONE;
+    request->error = error;
+    table->waiting--;
+    completed++;
+
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->slots[i].state == PENDING_WAITING && table->slots[i].ack_seq == seq) {
+            table->slots[i].state = PENDING_DONE;
+            table->slots[i].error = 0;
+            table->waiting--;
+            completed++;
+        }
+    }
+
+    return completed;
+}
+
+/**
+ * Completes every waiting request whose deadline passed with -ETIMEDOUT.
+ *
+ * @param table The table.
+ * @param now The current time in milliseconds.
+ * @return Number of expired requests.
+ */
+int pending_expire(struct pending_table *table, long long now) {
+    int expired = 0;
+
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->slots[i].state == PENDING_WAITING && table->slots[i].deadline <= now) {
+            table->slots[i].state = PENDING_DONE;
+            table->slots[i].error = -ETIMEDOUT;
+            table->waiting--;
+            expired++;
+        }
+    }
+
+    return expired;
+}
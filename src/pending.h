@@ -0,0 +1,148 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Table of the requests that were sent and didn't complete yet, keyed by sequence number.
+ *
+ * A request completes when its own ack/error/NLMSG_DONE arrives, or when the ack of the
+ * request it's acked by arrives (pipelines request an ack only on their last message,
+ * the kernel handles the messages in order so that ack means every earlier one succeeded).
+ */
+
+#ifndef PENDING_H
+#define PENDING_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+
+#define PENDING_DEFAULT_WINDOW 16
+
+// deadline of a request that never times out.
+#define PENDING_NO_DEADLINE LLONG_MAX
+
+enum pending_state {
+    PENDING_FREE,
+    PENDING_WAITING,
+    PENDING_DONE,
+};
+
+/**
+ * A request in the table.
+ *
+ * seq -> The request's sequence number.
+ * ack_seq -> Sequence number of the request whose ack completes this one.
+ * state -> The request's state (pending_state).
+ * error -> The outcome, zero upon success or a negative errno.
+ * deadline -> Time (in milliseconds) the request times out at, PENDING_NO_DEADLINE for never.
+ * data -> Owned by the user of the table (the replies of the request for example).
+ */
+struct pending_request {
+    unsigned int seq;
+    unsigned int ack_seq;
+    int state;
+    int error;
+    long long deadline;
+    void *data;
+};
+
+/**
+ * Open addressing hash table of requests.
+ *
+ * slots -> The table, capacity entries.
+ * capacity -> Number of slots, a power of two of at least twice count (grows as needed).
+ * window -> Maximum number of waiting requests.
+ * count -> Number of requests in the table (waiting or done and not removed yet).
+ * waiting -> Number of waiting requests.
+ */
+struct pending_table {
+    struct pending_request *slots;
+    int capacity;
+    int window;
+    int count;
+    int waiting;
+};
+
+/**
+ * Initializes a table.
+ *
+ * @param table The table.
+ * @param window Maximum number of waiting requests.
+ * @return zero upon success, -ENOMEM upon failure.
+ */
+int pending_init(struct pending_table *table, int window);
+
+/**
+ * Frees the table's slots, the data of the requests is the user's to free.
+ *
+ * @param table The table.
+ */
+void pending_free(struct pending_table *table);
+
+/**
+ * Adds a waiting request.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @param ack_seq Sequence number of the request whose ack completes this one.
+ * @param deadline Time (in milliseconds) the request times out at, PENDING_NO_DEADLINE for never.
+ * @return The request, NULL if the window is full, the seq is already in the table or out of memory.
+ */
+struct pending_request *pending_add(struct pending_table *table, unsigned int seq, unsigned int ack_seq, long long deadline);
+
+/**
+ * Finds a request.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @return The request, NULL if it isn't in the table.
+ */
+struct pending_request *pending_find(struct pending_table *table, unsigned int seq);
+
+/**
+ * Removes a request, pointers to other requests may be invalidated.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @return The removed request's data, NULL if it isn't in the table.
+ */
+void *pending_remove(struct pending_table *table, unsigned int seq);
+
+/**
+ * Completes a waiting request.
+ * Also completes every waiting request that is acked by it with success, whatever its own outcome:
+ * the kernel handles the requests in order and answers the ones without an ack only when they fail,
+ * so by the time the ack carrier is answered those that didn't answer succeeded.
+ *
+ * @param table The table.
+ * @param seq The request's sequence number.
+ * @param error The outcome, zero upon success or a negative errno.
+ * @return Number of completed requests.
+ */
+int pending_complete(struct pending_table *table, unsigned int seq, int error);
+
+/**
+ * Completes every waiting request whose deadline passed with -ETIMEDOUT.
+ *
+ * @param table The table.
+ * @param now The current time in milliseconds.
+ * @return Number of expired requests.
+ */
+int pending_expire(struct pending_table *table, long long now);
+
+#endif
@@ -0,0 +1,328 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "receiver.h"
+#include <errno.h>
+#include <sys/eventfd.h>
+
+/**
+ * Signals an eventfd.
+ */
+static void signal_fd(int fd) {
+    uint64_t one = 1;
+
+    // the counter can't overflow in practice, a failed write leaves the fd readable anyway.
+    while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR);
+}
+
+/**
+ * Clears an eventfd (non blocking).
+ */
+static void clear_fd(int fd) {
+    uint64_t count;
+
+    while (read(fd, &count, sizeof(count)) < 0 && errno == EINTR);
+}
+
+/**
+ * Waits until the consumer released room or the receiver is stopped.
+ *
+ * @return zero when there may be room, -1 if the receiver is stopped.
+ */
+static int wait_for_space(struct receiver *receiver) {
+    struct pollfd fds[2] = {
+        {.fd = receiver->space_fd, .events = POLLIN},
+        {.fd = receiver->stop_fd, .events = POLLIN},
+    };
+
+    if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+        return -1;
+    }
+
+    if (fds[1].revents) {
+        return -1;
+    }
+
+    clear_fd(receiver->space_fd);
+
+    return 0;
+}
+
+/**
+ * Copies a message into the ring, waiting for room if the ring is full.
+ *
+ * @return zero upon success, -1 if the receiver is stopped while waiting.
+ */
+static int ring_push(struct receiver *receiver, struct nlmsghdr *hdr) {
+    size_t need = NLMSG_ALIGN(hdr->nlmsg_len);
+    size_t head = atomic_load_explicit(&receiver->head, memory_order_relaxed);
+    size_t offset = head & (receiver->size - 1);
+    size_t contiguous = receiver->size - offset;
+    // a message that doesn't fit before the end of the ring starts over at the beginning.
+    size_t total = need <= contiguous ? need : contiguous + need;
+
+    if (need > receiver->size / 4) {
+        atomic_fetch_add_explicit(&receiver->stats.dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    while (receiver->size - (head - atomic_load_explicit(&receiver->tail, memory_order_acquire)) < total) {
+        atomic_store(&receiver->waiting, 1);
+
+        // the consumer may have released room before it saw the flag.
+        if (receiver->size - (head - atomic_load(&receiver->tail)) >= total) {
+            atomic_store(&receiver->waiting, 0);
+            break;
+        }
+
+        atomic_fetch_add_explicit(&receiver->stats.full, 1, memory_order_relaxed);
+
+        if (wait_for_space(receiver) < 0) {
+            atomic_store(&receiver->waiting, 0);
+            return -1;
+        }
+
+        atomic_store(&receiver->waiting, 0);
+    }
+
+    if (need > contiguous) {
+        *(uint32_t *) (receiver->ring + offset) = 0;
+        head += contiguous;
+        offset = 0;
+    }
+
+    memcpy(receiver->ring + offset, hdr, hdr->nlmsg_len);
+    atomic_store_explicit(&receiver->head, head + need, memory_order_release);
+
+    atomic_fetch_add_explicit(&receiver->stats.messages, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&receiver->stats.bytes, hdr->nlmsg_len, memory_order_relaxed);
+
+    return 0;
+}
+
+/**
+ * The receiving thread, reads the socket until the receiver is stopped.
+ */
+static void *receive(void *arg) {
+    struct receiver *receiver = arg;
+    struct pollfd fds[2] = {
+        {.fd = nl_socket_get_fd(receiver->nl->sock), .events = POLLIN},
+        {.fd = receiver->stop_fd, .events = POLLIN},
+    };
+
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            atomic_store(&receiver->error, -nl_syserr2nlerr(errno));
+            break;
+        }
+
+        if (fds[1].revents) {
+            break;
+        }
+
+        unsigned char *buf;
+        int len = recv_raw_nl(receiver->nl, &buf);
+
+        // an overrun is counted by recv_raw_nl, the socket is still usable.
+        if (len == 0 || len == -NLE_NOMEM) {
+            continue;
+        }
+
+        if (len < 0) {
+            atomic_store(&receiver->error, len);
+            break;
+        }
+
+        struct nlmsghdr *hdr = (struct nlmsghdr *) buf;
+        int stopped = 0;
+
+        atomic_fetch_add_explicit(&receiver->stats.datagrams, 1, memory_order_relaxed);
+
+        while (nlmsg_ok(hdr, len) && !stopped) {
+            stopped = ring_push(receiver, hdr) < 0;
+            hdr = nlmsg_next(hdr, &len);
+        }
+
+        free(buf);
+        signal_fd(receiver->data_fd);
+
+        if (stopped) {
+            break;
+        }
+    }
+
+    // wakes up the consumer so it sees the error.
+    signal_fd(receiver->data_fd);
+
+    return NULL;
+}
+
+/**
+ * Starts a receiver thread on a netlink.
+ * Nothing else may read the socket until the receiver is stopped.
+ *
+ * @param nl The netlink.
+ * @param ring_size Size of the ring in bytes, rounded up to a power of two (at least RECEIVER_MIN_RING).
+ * @return The receiver, NULL upon failure (errno is set).
+ */
+struct receiver *receiver_start(struct netlink *nl, size_t ring_size) {
+    struct receiver *receiver = calloc(1, sizeof(struct receiver));
+    size_t size = RECEIVER_MIN_RING;
+    int err;
+
+    if (receiver == NULL) {
+        return NULL;
+    }
+
+    while (size < ring_size && size <= SIZE_MAX / 2) {
+        size *= 2;
+    }
+
+    receiver->nl = nl;
+    receiver->size = size;
+    receiver->ring = malloc(size);
+    receiver->data_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    receiver->space_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    receiver->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    atomic_init(&receiver->head, 0);
+    atomic_init(&receiver->tail, 0);
+    atomic_init(&receiver->waiting, 0);
+    atomic_init(&receiver->error, 0);
+    atomic_init(&receiver->stats.datagrams, 0);
+    atomic_init(&receiver->stats.messages, 0);
+    atomic_init(&receiver->stats.bytes, 0);
+    atomic_init(&receiver->stats.full, 0);
+    atomic_init(&receiver->stats.dropped, 0);
+
+    if (receiver->ring == NULL || receiver->data_fd < 0 || receiver->space_fd < 0 || receiver->stop_fd < 0) {
+        goto failure;
+    }
+
+    err = pthread_create(&receiver->thread, NULL, receive, receiver);
+
+    if (err != 0) {
+        errno = err;
+        goto failure;
+    }
+
+    return receiver;
+
+failure:
+    err = errno;
+
+    if (receiver->data_fd >= 0) close(receiver->data_fd);
+    if (receiver->space_fd >= 0) close(receiver->space_fd);
+    if (receiver->stop_fd >= 0) close(receiver->stop_fd);
+    free(receiver->ring);
+    free(receiver);
+
+    errno = err;
+
+    return NULL;
+}
+
+/**
+ * Stops the receiver thread and frees the receiver, the messages left in the ring are dropped.
+ *
+ * @param receiver The receiver.
+ */
+void receiver_stop(struct receiver *receiver) {
+    signal_fd(receiver->stop_fd);
+    pthread_join(receiver->thread, NULL);
+
+    close(receiver->data_fd);
+    close(receiver->space_fd);
+    close(receiver->stop_fd);
+    free(receiver->ring);
+    free(receiver);
+}
+
+/**
+ * Waits until the ring has messages, or the producer stopped.
+ *
+ * @param receiver The receiver.
+ * @param timeout Timeout in milliseconds, negative to wait forever.
+ * @return positive if there are messages (or the producer stopped), zero on timeout, negative errno upon failure.
+ */
+int receiver_wait(struct receiver *receiver, int timeout) {
+    struct pollfd pfd = {
+        .fd = receiver->data_fd,
+        .events = POLLIN,
+    };
+
+    // the fd is cleared before checking the ring, so a datagram pushed after the check wakes the poll up.
+    clear_fd(receiver->data_fd);
+
+    if (receiver->read != atomic_load_explicit(&receiver->head, memory_order_acquire) || atomic_load(&receiver->error)) {
+        return 1;
+    }
+
+    int ret = poll(&pfd, 1, timeout);
+
+    if (ret < 0) {
+        return -errno;
+    }
+
+    return ret;
+}
+
+/**
+ * Takes the next message of the ring.
+ * The message stays valid until receiver_release is called.
+ *
+ * @param receiver The receiver.
+ * @return The message, NULL if the ring is empty.
+ */
+struct nlmsghdr *receiver_next(struct receiver *receiver) {
+    size_t head = atomic_load_explicit(&receiver->head, memory_order_acquire);
+
+    while (receiver->read != head) {
+        size_t offset = receiver->read & (receiver->size - 1);
+        struct nlmsghdr *hdr = (struct nlmsghdr *) (receiver->ring + offset);
+
+        if (hdr->nlmsg_len == 0) {
+            // the producer skipped the rest of the ring.
+            receiver->read += receiver->size - offset;
+            continue;
+        }
+
+        receiver->read += NLMSG_ALIGN(hdr->nlmsg_len);
+
+        return hdr;
+    }
+
+    return NULL;
+}
+
+/**
+ * Gives the room of the messages taken so far back to the producer.
+ *
+ * @param receiver The receiver.
+ */
+void receiver_release(struct receiver *receiver) {
+    // sequentially consistent, so the store isn't reordered after the load of the producer's flag.
+    atomic_store(&receiver->tail, receiver->read);
+
+    if (atomic_load(&receiver->waiting)) {
+        signal_fd(receiver->space_fd);
+    }
+}
@@ -0,0 +1,135 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Background receiver of a netlink socket.
+ *
+ * A native thread reads the socket continuously and copies every message into a single producer,
+ * single consumer ring, so bursts are absorbed by the ring instead of the socket's receive buffer.
+ * The ring itself is lock free, the threads only sleep on eventfds:
+ *   the consumer on the data eventfd (written after every datagram, so it can be watched by poll/asyncio),
+ *   the producer on the space eventfd while the ring is full (the socket buffer fills up meanwhile).
+ *
+ * None of the functions touch python objects, they may be called without holding the GIL.
+ * The consumer functions must be called from one thread at a time.
+ */
+
+#ifndef RECEIVER_H
+#define RECEIVER_H
+
+#include "netlink.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// smallest ring, a ring is at least big enough for a few dump datagrams.
+#define RECEIVER_MIN_RING (64 * 1024)
+
+/**
+ * Counters of a receiver, relaxed atomics written by the producer and read by any thread.
+ *
+ * datagrams -> Datagrams read from the socket.
+ * messages -> Messages put in the ring.
+ * bytes -> Bytes put in the ring.
+ * full -> Times the producer had to wait for the consumer because the ring was full.
+ * dropped -> Messages dropped because they are bigger than a quarter of the ring.
+ */
+struct receiver_stats {
+    atomic_ulong datagrams;
+    atomic_ulong messages;
+    atomic_ulong bytes;
+    atomic_ulong full;
+    atomic_ulong dropped;
+};
+
+/**
+ * A running receiver.
+ *
+ * nl -> The netlink the receiver reads.
+ * thread -> The receiving thread.
+ * ring -> The ring, messages are stored contiguously (NLMSG_ALIGNed),
+ *         a zero length marks that the rest of the ring was skipped.
+ * size -> Size of the ring, a power of two.
+ * head -> Bytes produced so far (written by the producer).
+ * tail -> Bytes released by the consumer so far.
+ * read -> Bytes read by the consumer so far, the messages between tail and read are still in use.
+ * data_fd -> eventfd written by the producer after every datagram.
+ * space_fd -> eventfd written by the consumer when it released room while the producer waits.
+ * stop_fd -> eventfd written to stop the producer.
+ * waiting -> Whether the producer waits for room.
+ * error -> The error that stopped the producer (negative libnl error code), zero while it runs.
+ * stats -> The counters.
+ */
+struct receiver {
+    struct netlink *nl;
+    pthread_t thread;
+    unsigned char *ring;
+    size_t size;
+    atomic_size_t head;
+    atomic_size_t tail;
+    size_t read;
+    int data_fd;
+    int space_fd;
+    int stop_fd;
+    atomic_int waiting;
+    atomic_int error;
+    struct receiver_stats stats;
+};
+
+/**
+ * Starts a receiver thread on a netlink.
+ * Nothing else may read the socket until the receiver is stopped.
+ *
+ * @param nl The netlink.
+ * @param ring_size Size of the ring in bytes, rounded up to a power of two (at least RECEIVER_MIN_RING).
+ * @return The receiver, NULL upon failure (errno is set).
+ */
+struct receiver *receiver_start(struct netlink *nl, size_t ring_size);
+
+/**
+ * Stops the receiver thread and frees the receiver, the messages left in the ring are dropped.
+ *
+ * @param receiver The receiver.
+ */
+void receiver_stop(struct receiver *receiver);
+
+/**
+ * Waits until the ring has messages, or the producer stopped.
+ *
+ * @param receiver The receiver.
+ * @param timeout Timeout in milliseconds, negative to wait forever.
+ * @return positive if there are messages (or the producer stopped), zero on timeout, negative errno upon failure.
+ */
+int receiver_wait(struct receiver *receiver, int timeout);
+
+/**
+ * Takes the next message of the ring.
+ * The message stays valid until receiver_release is called.
+ *
+ * @param receiver The receiver.
+ * @return The message, NULL if the ring is empty.
+ */
+struct nlmsghdr *receiver_next(struct receiver *receiver);
+
+/**
+ * Gives the room of the messages taken so far back to the producer.
+ *
+ * @param receiver The receiver.
+ */
+void receiver_release(struct receiver *receiver);
+
+#endif
@@ -0,0 +1,148 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "router.h"
+
+/**
+ * Finds where a key is or should be inserted.
+ *
+ * @param list The routes.
+ * @param key The key.
+ * @return Index of the first route whose key isn't smaller.
+ */
+static int route_index(const struct route_list *list, unsigned int key) {
+    int low = 0;
+    int high = list->count;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+
+        if (list->routes[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Sets the handler of a key.
+ *
+ * @param list The routes.
+ * @param key The key.
+ * @param handler The new handler, NULL removes the route.
+ * @param old Set to the replaced handler (the user's to free), NULL if there was none.
+ * @return zero upon success, -ENOMEM upon failure.
+ */
+int route_set(struct route_list *list, unsigned int key, void *handler, void **old) {
+    int i = route_index(list, key);
+    int found = i < list->count && list->routes[i].key == key;
+
+    *old = found ? list->routes[i].handler : NULL;
+
+    if (found && handler != NULL) {
+        list->routes[i].handler = handler;
+    } else if (found) {
+        memmove(&list->routes[i], &list->routes[i + 1], (list->count - i - 1) * sizeof(struct route));
+        list->count--;
+    } else if (handler != NULL) {
+        if (list->count == list->capacity) {
+            int capacity = list->capacity ? list->capacity * 2 : 8;
+            struct route *routes = realloc(list->routes, capacity * sizeof(struct route));
+
+            if (routes == NULL) {
+                return -ENOMEM;
+            }
+
+            list->routes = routes;
+            list->capacity = capacity;
+        }
+
+        memmove(&list->routes[i + 1], &list->routes[i], (list->count - i) * sizeof(struct route));
+        list->routes[i] = (struct route) {
+            .key = key,
+            .handler = handler,
+        };
+        list->count++;
+    }
+
+    return 0;
+}
+
+/**
+ * Finds the handler of a key.
+ *
+ * @param list The routes.
+ * @param key The key.
+ * @return The handler, NULL if there is no route.
+ */
+void *route_find(const struct route_list *list, unsigned int key) {
+    int i = route_index(list, key);
+
+    return i < list->count && list->routes[i].key == key ? list->routes[i].handler : NULL;
+}
+
+/**
+ * Finds the handler of a message.
+ *
+ * @param router The router.
+ * @param hdr The message.
+ * @param group The multicast group the message was received on, zero if unicast.
+ * @param family The generic netlink family whose commands are routed, -1 if none.
+ * @return The handler, NULL if nobody handles the message.
+ */
+void *router_lookup(const struct router *router, const struct nlmsghdr *hdr, unsigned int group, int family) {
+    void *handler = NULL;
+
+    if (router->cmds > 0 && family >= NLMSG_MIN_TYPE && hdr->nlmsg_type == family
+            && hdr->nlmsg_len >= NLMSG_LENGTH(GENL_HDRLEN)) {
+        const struct genlmsghdr *genl = NLMSG_DATA(hdr);
+        handler = router->by_cmd[genl->cmd];
+    }
+
+    if (handler == NULL) {
+        handler = route_find(&router->types, hdr->nlmsg_type);
+    }
+
+    if (handler == NULL && group != 0) {
+        handler = route_find(&router->groups, group);
+    }
+
+    return handler != NULL ? handler : router->fallback;
+}
+
+/**
+ * Removes every route.
+ *
+ * @param router The router.
+ * @param release Called with every handler, may be NULL.
+ */
+void router_clear(struct router *router, void (*release)(void *handler)) {
+    if (release != NULL) {
+        for (int i = 0; i < router->types.count; i++) release(router->types.routes[i].handler);
+        for (int i = 0; i < router->groups.count; i++) release(router->groups.routes[i].handler);
+        for (int i = 0; i < ROUTER_MAX_CMD; i++) if (router->by_cmd[i] != NULL) release(router->by_cmd[i]);
+        if (router->fallback != NULL) release(router->fallback);
+    }
+
+    free(router->types.routes);
+    free(router->groups.routes);
+    memset(router, 0, sizeof(*router));
+}
@@ -0,0 +1,120 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Routes received messages to their handlers, without calling into python for messages nobody handles.
+ *
+ * A message is routed by the first match of:
+ *   1. its generic netlink command, for messages of the routed family.
+ *   2. its nlmsg_type.
+ *   3. the multicast group it was received on.
+ *   4. the default handler.
+ */
+
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+
+#define ROUTER_MAX_CMD 256
+
+/**
+ * A route.
+ *
+ * key -> The nlmsg_type or multicast group.
+ * handler -> Owned by the user of the router (a python callable for example).
+ */
+struct route {
+    unsigned int key;
+    void *handler;
+};
+
+/**
+ * Routes sorted by key, looked up with a binary search.
+ *
+ * routes -> The routes, count entries.
+ * count -> Number of routes.
+ * capacity -> Number of allocated routes.
+ */
+struct route_list {
+    struct route *routes;
+    int count;
+    int capacity;
+};
+
+/**
+ * The routing table.
+ *
+ * types -> Routes by nlmsg_type.
+ * groups -> Routes by multicast group.
+ * by_cmd -> Routes by generic netlink command, NULL where there is none.
+ * cmds -> Number of command routes.
+ * fallback -> The default handler, NULL if none.
+ */
+struct router {
+    struct route_list types;
+    struct route_list groups;
+    void *by_cmd[ROUTER_MAX_CMD];
+    int cmds;
+    void *fallback;
+};
+
+/**
+ * Sets the handler of a key.
+ *
+ * @param list The routes.
+ * @param key The key.
+ * @param handler The new handler, NULL removes the route.
+ * @param old Set to the replaced handler (the user's to free), NULL if there was none.
+ * @return zero upon success, -ENOMEM upon failure.
+ */
+int route_set(struct route_list *list, unsigned int key, void *handler, void **old);
+
+/**
+ * Finds the handler of a key.
+ *
+ * @param list The routes.
+ * @param key The key.
+ * @return The handler, NULL if there is no route.
+ */
+void *route_find(const struct route_list *list, unsigned int key);
+
+/**
+ * Finds the handler of a message.
+ *
+ * @param router The router.
+ * @param hdr The message.
+ * @param group The multicast group the message was received on, zero if unicast.
+ * @param family The generic netlink family whose commands are routed, -1 if none.
+ * @return The handler, NULL if nobody handles the message.
+ */
+void *router_lookup(const struct router *router, const struct nlmsghdr *hdr, unsigned int group, int family);
+
+/**
+ * Removes every route.
+ *
+ * @param router The router.
+ * @param release Called with every handler, may be NULL.
+ */
+void router_clear(struct router *router, void (*release)(void *handler));
+
+#endif
@@ -0,0 +1,297 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "rtnl_dump.h"
+#include "message_pool.h"
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/if_addr.h>
+#include <linux/neighbour.h>
+#include <unistd.h>
+#include <stdint.h>
+
+/**
+ * Creates a dump request with a zeroed family header.
+ *
+ * @param cls The message type.
+ * @param type The request's nlmsg_type.
+ * @param hdrlen Length of the family header.
+ * @param header Set to the family header.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+static Message *dump_request(PyObject *cls, int type, int hdrlen, void **header) {
+	Message *message = message_alloc((PyTypeObject *) cls);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	message->msg = message_pool_acquire(getpagesize());
+
+	if (message->msg == NULL) {
+		Py_DECREF(message);
+		return (Message *) PyErr_NoMemory();
+	}
+
+	struct nlmsghdr *nlh = nlmsg_put(message->msg, NL_AUTO_PORT, NL_AUTO_SEQ, type, hdrlen, NLM_F_REQUEST | NLM_F_DUMP);
+
+	if (nlh == NULL) {
+		Py_DECREF(message);
+		PyErr_SetString(PyExc_MemoryError, "Can't put the message header");
+		return NULL;
+	}
+
+	// nlmsg_put zeroes the family header.
+	*header = nlmsg_data(nlh);
+
+	return message;
+}
+
+/**
+ * O& converter of an optional filter argument, None means not filtered (zero).
+ *
+ * @param obj The argument.
+ * @param max The largest value the filter fits.
+ * @param value Set to the filter.
+ * @return 1 upon success, 0 with an exception set upon failure.
+ */
+static int filter_arg(PyObject *obj, unsigned long max, unsigned long *value) {
+	if (obj == Py_None) {
+		*value = 0;
+		return 1;
+	}
+
+	*value = PyLong_AsUnsignedLong(obj);
+
+	if (*value == (unsigned long) -1 && PyErr_Occurred()) {
+		return 0;
+	}
+
+	if (*value > max) {
+		PyErr_Format(PyExc_OverflowError, "Filter %lu is larger than %lu", *value, max);
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * O& converter of an optional u8 filter argument.
+ *
+ * @param obj The argument.
+ * @param out Set to the filter (unsigned char).
+ * @return 1 upon success, 0 with an exception set upon failure.
+ */
+static int filter_u8(PyObject *obj, void *out) {
+	unsigned long value;
+
+	if (!filter_arg(obj, UINT8_MAX, &value)) {
+		return 0;
+	}
+
+	*(unsigned char *) out = value;
+
+	return 1;
+}
+
+/**
+ * O& converter of an optional u32 filter argument.
+ *
+ * @param obj The argument.
+ * @param out Set to the filter (unsigned int).
+ * @return 1 upon success, 0 with an exception set upon failure.
+ */
+static int filter_u32(PyObject *obj, void *out) {
+	unsigned long value;
+
+	if (!filter_arg(obj, UINT32_MAX, &value)) {
+		return 0;
+	}
+
+	*(unsigned int *) out = value;
+
+	return 1;
+}
+
+/**
+ * Puts a u32 filter attribute, unless the filter is unset (zero).
+ *
+ * @return zero upon success, -1 with an exception set upon failure.
+ */
+static int put_filter(Message *message, int type, unsigned int value) {
+	if (value != 0 && nla_put_u32(message->msg, type, value) < 0) {
+		PyErr_SetString(PyExc_MemoryError, "Can't put the filter attribute");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Message.link_dump classmethod, creates a filtered RTM_GETLINK dump request.
+ *
+ * @param cls The message type.
+ * @param args family, master and kind.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_link_dump(PyObject *cls, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family", "master", "kind", NULL};
+	unsigned char family = AF_UNSPEC;
+	unsigned int master = 0;
+	const char *kind = NULL;
+	struct ifinfomsg *ifi;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&O&z:link_dump", kwlist, filter_u8, &family, filter_u32, &master, &kind)) {
+		return NULL;
+	}
+
+	Message *message = dump_request(cls, RTM_GETLINK, sizeof(*ifi), (void **) &ifi);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	ifi->ifi_family = family;
+
+	if (put_filter(message, IFLA_MASTER, master) < 0) {
+		Py_DECREF(message);
+		return NULL;
+	}
+
+	if (kind != NULL) {
+		struct nlattr *linkinfo = nla_nest_start(message->msg, IFLA_LINKINFO);
+
+		if (linkinfo == NULL || nla_put_string(message->msg, IFLA_INFO_KIND, kind) < 0) {
+			Py_DECREF(message);
+			PyErr_SetString(PyExc_MemoryError, "Can't put the filter attribute");
+			return NULL;
+		}
+
+		nla_nest_end(message->msg, linkinfo);
+	}
+
+	return (PyObject *) message;
+}
+
+/**
+ * Message.addr_dump classmethod, creates a filtered RTM_GETADDR dump request.
+ *
+ * @param cls The message type.
+ * @param args family and ifindex.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_addr_dump(PyObject *cls, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family", "ifindex", NULL};
+	unsigned char family = AF_UNSPEC;
+	unsigned int ifindex = 0;
+	struct ifaddrmsg *ifa;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&O&:addr_dump", kwlist, filter_u8, &family, filter_u32, &ifindex)) {
+		return NULL;
+	}
+
+	Message *message = dump_request(cls, RTM_GETADDR, sizeof(*ifa), (void **) &ifa);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	ifa->ifa_family = family;
+	ifa->ifa_index = ifindex;
+
+	return (PyObject *) message;
+}
+
+/**
+ * Message.route_dump classmethod, creates a filtered RTM_GETROUTE dump request.
+ *
+ * @param cls The message type.
+ * @param args family, table, protocol, type and oif.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_route_dump(PyObject *cls, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family", "table", "protocol", "type", "oif", NULL};
+	unsigned char family = AF_UNSPEC;
+	unsigned int table = 0;
+	unsigned char protocol = 0;
+	unsigned char type = 0;
+	unsigned int oif = 0;
+	struct rtmsg *rtm;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&O&O&O&O&:route_dump", kwlist, filter_u8, &family, filter_u32, &table, filter_u8, &protocol, filter_u8, &type, filter_u32, &oif)) {
+		return NULL;
+	}
+
+	Message *message = dump_request(cls, RTM_GETROUTE, sizeof(*rtm), (void **) &rtm);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	rtm->rtm_family = family;
+	rtm->rtm_protocol = protocol;
+	rtm->rtm_type = type;
+	// tables above 255 only fit in RTA_TABLE.
+	rtm->rtm_table = table <= 0xff ? table : RT_TABLE_UNSPEC;
+
+	if (put_filter(message, RTA_TABLE, table) < 0 || put_filter(message, RTA_OIF, oif) < 0) {
+		Py_DECREF(message);
+		return NULL;
+	}
+
+	return (PyObject *) message;
+}
+
+/**
+ * Message.neigh_dump classmethod, creates a filtered RTM_GETNEIGH dump request.
+ *
+ * @param cls The message type.
+ * @param args family, ifindex and master.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_neigh_dump(PyObject *cls, PyObject *args, PyObject *kwds) {
+	static char *kwlist[] = {"family", "ifindex", "master", NULL};
+	unsigned char family = AF_UNSPEC;
+	unsigned int ifindex = 0;
+	unsigned int master = 0;
+	struct ndmsg *ndm;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&O&O&:neigh_dump", kwlist, filter_u8, &family, filter_u32, &ifindex, filter_u32, &master)) {
+		return NULL;
+	}
+
+	Message *message = dump_request(cls, RTM_GETNEIGH, sizeof(*ndm), (void **) &ndm);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	ndm->ndm_family = family;
+
+	// strict checking rejects a dump request with ndm_ifindex set, the device filter is NDA_IFINDEX.
+	if (put_filter(message, NDA_IFINDEX, ifindex) < 0 || put_filter(message, NDA_MASTER, master) < 0) {
+		Py_DECREF(message);
+		return NULL;
+	}
+
+	return (PyObject *) message;
+}
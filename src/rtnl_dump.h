@@ -0,0 +1,77 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Builders of rtnetlink dump requests carrying filters.
+ *
+ * With NETLINK_GET_STRICT_CHK enabled (NetLink.set_strict_check) the kernel applies the filters of the request's
+ * header and attributes itself and only emits the matching objects, without it the filters are ignored.
+ */
+
+#ifndef RTNL_DUMP_H
+#define RTNL_DUMP_H
+
+#include "Python.h"
+#include "message.h"
+
+#define link_dump_docs "Creates a filtered link dump request (RTM_GETLINK).\n@param family The address family (default AF_UNSPEC)\n@param master Only the links enslaved to this link (IFLA_MASTER, default 0 or None for all)\n@param kind Only the links of this kind, e.g. \"vlan\" (IFLA_INFO_KIND, default None for all, the kernel ignores kinds whose driver isn't loaded)\n@return Message"
+#define addr_dump_docs "Creates a filtered address dump request (RTM_GETADDR).\n@param family The address family (default AF_UNSPEC)\n@param ifindex Only the addresses of this link (default 0 or None for all)\n@return Message"
+#define route_dump_docs "Creates a filtered route dump request (RTM_GETROUTE).\n@param family The address family (default AF_UNSPEC)\n@param table Only the routes of this table (default 0 or None for all)\n@param protocol Only the routes of this protocol, e.g. RTPROT_BOOT (default 0 or None for all)\n@param type Only the routes of this type, e.g. RTN_UNICAST (default 0 or None for all)\n@param oif Only the routes through this link (RTA_OIF, default 0 or None for all)\n@return Message"
+#define neigh_dump_docs "Creates a filtered neighbour dump request (RTM_GETNEIGH).\n@param family The address family (default AF_UNSPEC)\n@param ifindex Only the neighbours of this link (default 0 or None for all)\n@param master Only the neighbours of the links enslaved to this link (NDA_MASTER, default 0 or None for all)\n@return Message"
+
+/**
+ * Message.link_dump classmethod, creates a filtered RTM_GETLINK dump request.
+ *
+ * @param cls The message type.
+ * @param args family, master and kind.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_link_dump(PyObject *cls, PyObject *args, PyObject *kwds);
+
+/**
+ * Message.addr_dump classmethod, creates a filtered RTM_GETADDR dump request.
+ *
+ * @param cls The message type.
+ * @param args family and ifindex.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_addr_dump(PyObject *cls, PyObject *args, PyObject *kwds);
+
+/**
+ * Message.route_dump classmethod, creates a filtered RTM_GETROUTE dump request.
+ *
+ * @param cls The message type.
+ * @param args family, table, protocol, type and oif.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_route_dump(PyObject *cls, PyObject *args, PyObject *kwds);
+
+/**
+ * Message.neigh_dump classmethod, creates a filtered RTM_GETNEIGH dump request.
+ *
+ * @param cls The message type.
+ * @param args family, ifindex and master.
+ * @param kwds Keywords.
+ * @return A new Message, NULL with an exception set upon failure.
+ */
+PyObject *rtnl_neigh_dump(PyObject *cls, PyObject *args, PyObject *kwds);
+
+#endif
@@ -0,0 +1,174 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "stream.h"
+
+/**
+ * Returns the message at an offset of a stream.
+ *
+ * @param buffer The stream.
+ * @param offset Offset of the message.
+ * @return The message, NULL if the stream has no full message at the offset.
+ */
+static struct nlmsghdr *stream_message(Py_buffer *buffer, Py_ssize_t offset) {
+	struct nlmsghdr *nlh = (struct nlmsghdr *) ((char *) buffer->buf + offset);
+	Py_ssize_t remaining = buffer->len - offset;
+
+	// remaining is bounded by INT_MAX for nlmsg_ok, the longest message is UINT32_MAX anyway.
+	return nlmsg_ok(nlh, remaining > INT_MAX ? INT_MAX : (int) remaining) ? nlh : NULL;
+}
+
+/**
+ * Creates an iterator over the messages of a byte stream.
+ *
+ * @param type Type of the yielded messages, Message or one of its C subclasses.
+ * @param object Any object supporting the buffer protocol.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+StreamIterator *stream_iterator_new(PyTypeObject *type, PyObject *object) {
+	StreamIterator *iterator = PyObject_New(StreamIterator, &StreamIteratorType);
+
+	if (iterator == NULL) {
+		return NULL;
+	}
+
+	if (PyObject_GetBuffer(object, &iterator->buffer, PyBUF_SIMPLE) < 0) {
+		iterator->buffer.obj = NULL;
+		iterator->type = NULL;
+		Py_DECREF(iterator);
+		return NULL;
+	}
+
+	Py_INCREF(type);
+	iterator->type = type;
+	iterator->offset = 0;
+	iterator->count = 0;
+
+	return iterator;
+}
+
+/**
+ * Splits a byte stream into messages in one pass.
+ * The walk stops at the first truncated message (or trailing bytes shorter than a header).
+ *
+ * @param type Type of the messages, Message or one of its C subclasses.
+ * @param object Any object supporting the buffer protocol.
+ * @param index Whether to return an index of tuples (offset, len, type, flags, seq, pid) instead of messages.
+ * @return A new list, NULL with an exception set upon failure.
+ */
+PyObject *stream_decode(PyTypeObject *type, PyObject *object, int index) {
+	Py_buffer buffer;
+	struct nlmsghdr *nlh;
+	Py_ssize_t offset = 0;
+
+	if (PyObject_GetBuffer(object, &buffer, PyBUF_SIMPLE) < 0) {
+		return NULL;
+	}
+
+	PyObject *result = PyList_New(0);
+
+	while (result != NULL && (nlh = stream_message(&buffer, offset)) != NULL) {
+		PyObject *item;
+
+		if (index) {
+			item = Py_BuildValue("(nIHHII)", offset, nlh->nlmsg_len, nlh->nlmsg_type, nlh->nlmsg_flags,
+			                     nlh->nlmsg_seq, nlh->nlmsg_pid);
+		} else {
+			item = (PyObject *) message_wrap(type, object, nlh);
+		}
+
+		if (item == NULL || PyList_Append(result, item) < 0) {
+			Py_XDECREF(item);
+			Py_CLEAR(result);
+			break;
+		}
+
+		Py_DECREF(item);
+		offset += NLMSG_ALIGN(nlh->nlmsg_len);
+	}
+
+	PyBuffer_Release(&buffer);
+
+	return result;
+}
+
+static PyObject *StreamIterator_next(StreamIterator *self) {
+	struct nlmsghdr *nlh = self->offset < self->buffer.len ? stream_message(&self->buffer, self->offset) : NULL;
+
+	if (nlh == NULL) {
+		return NULL;
+	}
+
+	Message *message = message_wrap(self->type, self->buffer.obj, nlh);
+
+	if (message == NULL) {
+		return NULL;
+	}
+
+	self->offset += NLMSG_ALIGN(nlh->nlmsg_len);
+	self->count++;
+
+	return (PyObject *) message;
+}
+
+static void StreamIterator_dealloc(StreamIterator *self) {
+	if (self->buffer.obj != NULL) {
+		PyBuffer_Release(&self->buffer);
+	}
+
+	Py_XDECREF(self->type);
+
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMemberDef StreamIterator_members[] = {
+    {"offset", T_PYSSIZET, offsetof(StreamIterator, offset), READONLY, "Offset of the next message, once exhausted the bytes from offset on don't hold a full message."},
+    {"count", T_LONG, offsetof(StreamIterator, count), READONLY, "Number of messages yielded so far."},
+    {NULL} /* Sentinel */
+};
+
+PyTypeObject StreamIteratorType = {
+    PyVarObject_HEAD_INIT(NULL, 0) "netlink.StreamIterator", /* tp_name */
+    sizeof(StreamIterator),                           /* tp_basicsize */
+    0,                                                /* tp_itemsize */
+    (destructor)StreamIterator_dealloc,               /* tp_dealloc */
+    0,                                                /* tp_print */
+    0,                                                /* tp_getattr */
+    0,                                                /* tp_setattr */
+    0,                                                /* tp_reserved */
+    0,                                                /* tp_repr */
+    0,                                                /* tp_as_number */
+    0,                                                /* tp_as_sequence */
+    0,                                                /* tp_as_mapping */
+    0,                                                /* tp_hash  */
+    0,                                                /* tp_call */
+    0,                                                /* tp_str */
+    0,                                                /* tp_getattro */
+    0,                                                /* tp_setattro */
+    0,                                                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                               /* tp_flags */
+    "Iterator over the messages of a byte stream, the messages wrap the stream's buffer.", /* tp_doc */
+    0,                                                       /* tp_traverse */
+    0,                                                       /* tp_clear */
+    0,                      /* tp_richcompare */
+    0,                      /* tp_weaklistoffset */
+    PyObject_SelfIter,      /* tp_iter */
+    (iternextfunc)StreamIterator_next, /* tp_iternext */
+    0,                      /* tp_methods */
+    StreamIterator_members, /* tp_members */
+};
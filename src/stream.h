@@ -0,0 +1,65 @@
+/*
+    Python client for the Netlink interface.
+    Copyright (C) 2023 Boaz Tene
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Python.h"
+#include <structmember.h>
+#include "message.h"
+
+/**
+ * Iterator over the messages of a byte stream (a datagram, or recorded netlink traffic).
+ * The messages wrap the stream's buffer, nothing is copied.
+ *
+ * type -> Type of the yielded messages, Message or one of its C subclasses.
+ * buffer -> The stream.
+ * offset -> Offset of the next message, where the walk stopped once the iterator is exhausted.
+ * count -> Number of messages yielded so far.
+ */
+typedef struct {
+    PyObject_HEAD
+    PyTypeObject *type;
+    Py_buffer buffer;
+    Py_ssize_t offset;
+    long count;
+} StreamIterator;
+
+extern PyTypeObject StreamIteratorType;
+
+/**
+ * Creates an iterator over the messages of a byte stream.
+ *
+ * @param type Type of the yielded messages, Message or one of its C subclasses.
+ * @param object Any object supporting the buffer protocol.
+ * @return A new reference, NULL with an exception set upon failure.
+ */
+StreamIterator *stream_iterator_new(PyTypeObject *type, PyObject *object);
+
+/**
+ * Splits a byte stream into messages in one pass.
+ * The walk stops at the first truncated message (or trailing bytes shorter than a header).
+ *
+ * @param type Type of the messages, Message or one of its C subclasses.
+ * @param object Any object supporting the buffer protocol.
+ * @param index Whether to return an index of tuples (offset, len, type, flags, seq, pid) instead of messages.
+ * @return A new list, NULL with an exception set upon failure.
+ */
+PyObject *stream_decode(PyTypeObject *type, PyObject *object, int index);
+
+#endif